@@ -0,0 +1,319 @@
+#include "duckdb.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+
+#include "nf_localedata.h"
+#include "nf_zformat.h"
+#include "xlsx/parsers/worksheet_parser.hpp"
+#include "xlsx/read_xlsx.hpp"
+#include "xlsx/string_table.hpp"
+#include "xlsx/xlsx_writer.hpp"
+#include "xlsx/xml_util.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <regex>
+
+namespace duckdb {
+
+//-------------------------------------------------------------------
+// Micro Benchmarks
+//-------------------------------------------------------------------
+// Benchmarks the hot components of the reader and writer in
+// isolation, over in-memory inputs, so that regressions can be
+// attributed to a component without the noise of the query engine.
+//
+// Every benchmark runs a number of times and reports the median time
+// per item (usually a cell) and the throughput over its input bytes.
+//
+// Usage: excel_micro_benchmark [regex] [repetitions]
+//-------------------------------------------------------------------
+
+struct MicroBenchmarkResult {
+	idx_t items = 0;
+	idx_t bytes = 0;
+};
+
+struct MicroBenchmark {
+	string name;
+	std::function<MicroBenchmarkResult()> run;
+};
+
+// Results are accumulated here so that the compiler can't optimize the benchmarked code away
+static volatile uint64_t benchmark_sink = 0;
+
+static void RunBenchmark(const MicroBenchmark &benchmark, const idx_t repetitions) {
+	vector<double> timings;
+	MicroBenchmarkResult result;
+
+	// Do one warmup run, that is not measured
+	benchmark.run();
+
+	for (idx_t i = 0; i < repetitions; i++) {
+		const auto start = std::chrono::steady_clock::now();
+		result = benchmark.run();
+		const auto end = std::chrono::steady_clock::now();
+		timings.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+	}
+
+	std::sort(timings.begin(), timings.end());
+	const auto median_ns = timings[timings.size() / 2];
+	const auto ns_per_item = result.items ? median_ns / static_cast<double>(result.items) : 0.0;
+	const auto mb_per_sec = static_cast<double>(result.bytes) / (median_ns / 1e9) / (1024.0 * 1024.0);
+
+	printf("%-40s %12llu items %10.2f ns/item %10.2f MB/s %10.3f ms\n", benchmark.name.c_str(),
+	       static_cast<unsigned long long>(result.items), ns_per_item, mb_per_sec, median_ns / 1e6);
+}
+
+//-------------------------------------------------------------------
+// Inputs
+//-------------------------------------------------------------------
+static constexpr idx_t SHEET_ROWS = 100000;
+static constexpr idx_t SHEET_COLS = 8;
+static constexpr idx_t SHARED_STRINGS = 10000;
+
+// Generate the xml of a worksheet with a mix of numbers, shared strings and inline strings
+static string GenerateSheetXML() {
+	string xml;
+	xml += "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n";
+	xml += "<worksheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\"><sheetData>";
+	for (idx_t row_idx = 1; row_idx <= SHEET_ROWS; row_idx++) {
+		const auto row_str = std::to_string(row_idx);
+		xml += "<row r=\"" + row_str + "\">";
+		for (idx_t col_idx = 0; col_idx < SHEET_COLS; col_idx++) {
+			const auto ref = XLSXCellPos(row_idx, col_idx + 1).ToString();
+			switch (col_idx % 4) {
+			case 0:
+				xml += "<c r=\"" + ref + "\"><v>" + std::to_string(row_idx * 3.25) + "</v></c>";
+				break;
+			case 1:
+				xml += "<c r=\"" + ref + "\" t=\"s\"><v>" + std::to_string((row_idx * 7 + col_idx) % SHARED_STRINGS) +
+				       "</v></c>";
+				break;
+			case 2:
+				xml += "<c r=\"" + ref + "\" t=\"inlineStr\"><is><t>text " + row_str + "</t></is></c>";
+				break;
+			default:
+				xml += "<c r=\"" + ref + "\" s=\"1\"><v>" + std::to_string(36526 + row_idx % 10000) + "</v></c>";
+				break;
+			}
+		}
+		xml += "</row>";
+	}
+	xml += "</sheetData></worksheet>";
+	return xml;
+}
+
+static vector<string> GenerateStrings(const idx_t count, const idx_t distinct) {
+	vector<string> result;
+	result.reserve(count);
+	for (idx_t i = 0; i < count; i++) {
+		result.push_back("string value " + std::to_string((i * 2654435761ULL) % distinct));
+	}
+	return result;
+}
+
+// Counts cells without doing anything with them, measures the raw xml traversal
+class CellCounter final : public SheetParserBase {
+public:
+	idx_t cells = 0;
+	idx_t bytes = 0;
+
+protected:
+	void OnCell(const XLSXCellPos &pos, XLSXCellType type, vector<char> &data, idx_t style) override {
+		cells++;
+		bytes += data.size();
+	}
+};
+
+// Feed a buffer to a parser in chunks, like the reader does with the inflated zip stream
+template <class F>
+static void ParseBuffer(XMLParser &parser, const string &xml, F &&on_suspend) {
+	static constexpr idx_t BUFFER_SIZE = 2048;
+	for (idx_t pos = 0; pos < xml.size(); pos += BUFFER_SIZE) {
+		const auto len = MinValue(BUFFER_SIZE, xml.size() - pos);
+		auto status = parser.Parse(xml.data() + pos, len, pos + len == xml.size());
+		while (status == XMLParseResult::SUSPENDED) {
+			on_suspend();
+			status = parser.Resume();
+		}
+		if (status == XMLParseResult::ABORTED) {
+			return;
+		}
+	}
+}
+
+//-------------------------------------------------------------------
+// Benchmarks
+//-------------------------------------------------------------------
+static vector<MicroBenchmark> GetBenchmarks(ClientContext &context, const string &sheet_xml,
+                                            const StringTable &sheet_strings) {
+	vector<MicroBenchmark> benchmarks;
+	auto &buffer_manager = BufferManager::GetBufferManager(context);
+
+	// Parsing
+	benchmarks.push_back({"xml_parser/sheet_traverse", [&]() {
+		                      CellCounter parser;
+		                      ParseBuffer(parser, sheet_xml, []() {});
+		                      benchmark_sink += parser.cells + parser.bytes;
+		                      return MicroBenchmarkResult {parser.cells, sheet_xml.size()};
+	                      }});
+
+	benchmarks.push_back({"sheet_parser/fill_chunks", [&]() {
+		                      const XLSXCellRange range(1, 1, SHEET_ROWS + 1, SHEET_COLS + 1);
+		                      SheetParser parser(context, range, sheet_strings, false);
+		                      idx_t rows = 0;
+		                      parser.ResetChunk();
+		                      ParseBuffer(parser, sheet_xml, [&]() {
+			                      rows += parser.GetChunk().size();
+			                      parser.ResetChunk();
+		                      });
+		                      rows += parser.GetChunk().size();
+		                      benchmark_sink += rows;
+		                      return MicroBenchmarkResult {rows * SHEET_COLS, sheet_xml.size()};
+	                      }});
+
+	// String table
+	static const auto unique_strings = GenerateStrings(SHEET_ROWS, SHEET_ROWS);
+	static const auto repeated_strings = GenerateStrings(SHEET_ROWS, 100);
+
+	const auto add_strings = [&buffer_manager](const vector<string> &strings) {
+		StringTable table(buffer_manager);
+		idx_t bytes = 0;
+		for (const auto &str : strings) {
+			benchmark_sink += table.Add(string_t(str));
+			bytes += str.size();
+		}
+		return MicroBenchmarkResult {strings.size(), bytes};
+	};
+	benchmarks.push_back({"string_table/add_unique", [=]() { return add_strings(unique_strings); }});
+	benchmarks.push_back({"string_table/add_repeated", [=]() { return add_strings(repeated_strings); }});
+
+	benchmarks.push_back({"string_table/get", [&]() {
+		                      idx_t bytes = 0;
+		                      for (idx_t i = 0; i < sheet_strings.Count(); i++) {
+			                      bytes += sheet_strings.Get(i).GetSize();
+		                      }
+		                      benchmark_sink += bytes;
+		                      return MicroBenchmarkResult {sheet_strings.Count(), bytes};
+	                      }});
+
+	// Writing
+	benchmarks.push_back({"xml_util/escape_xml_string", [&]() {
+		                      static const auto strings = GenerateStrings(SHEET_ROWS, SHEET_ROWS);
+		                      string escaped;
+		                      idx_t bytes = 0;
+		                      for (const auto &str : strings) {
+			                      EscapeXMLString(str.c_str(), str.size(), escaped);
+			                      bytes += str.size();
+			                      benchmark_sink += escaped.size();
+		                      }
+		                      return MicroBenchmarkResult {strings.size(), bytes};
+	                      }});
+
+	benchmarks.push_back({"xlsx_writer/row_buffer", [&]() {
+		                      static const auto strings = GenerateStrings(SHEET_ROWS, SHEET_ROWS);
+		                      static const string number = "12345.6789";
+		                      XLSXRowBuffer rows(SHEET_COLS);
+		                      idx_t bytes = 0;
+		                      for (idx_t row_idx = 0; row_idx < SHEET_ROWS; row_idx++) {
+			                      rows.BeginRow();
+			                      for (idx_t col_idx = 0; col_idx < SHEET_COLS; col_idx++) {
+				                      if (col_idx % 2 == 0) {
+					                      rows.WriteNumberCell(string_t(number));
+					                      bytes += number.size();
+				                      } else {
+					                      rows.WriteInlineStringCell(string_t(strings[row_idx]));
+					                      bytes += strings[row_idx].size();
+				                      }
+			                      }
+			                      rows.EndRow();
+		                      }
+		                      benchmark_sink += rows.GetSizeInBytes();
+		                      return MicroBenchmarkResult {SHEET_ROWS * SHEET_COLS, bytes};
+	                      }});
+
+	// Cell references
+	benchmarks.push_back({"xlsx_cell_pos/try_parse", [&]() {
+		                      static vector<string> refs;
+		                      if (refs.empty()) {
+			                      for (idx_t i = 0; i < SHEET_ROWS; i++) {
+				                      refs.push_back(XLSXCellPos(i + 1, (i * 31) % XLSX_MAX_CELL_COLS + 1).ToString());
+			                      }
+		                      }
+		                      idx_t bytes = 0;
+		                      for (const auto &ref : refs) {
+			                      XLSXCellPos pos;
+			                      if (pos.TryParse(ref.c_str())) {
+				                      benchmark_sink += pos.row + pos.col;
+			                      }
+			                      bytes += ref.size();
+		                      }
+		                      return MicroBenchmarkResult {refs.size(), bytes};
+	                      }});
+
+	// Conversions
+	benchmarks.push_back({"convert/excel_to_epoch_us", [&]() {
+		                      for (idx_t i = 0; i < SHEET_ROWS; i++) {
+			                      const auto serial = 36526.0 + static_cast<double>(i) / 7.0;
+			                      const auto stamp = Timestamp::FromEpochMicroSeconds(ExcelToEpochUS(serial));
+			                      benchmark_sink += static_cast<uint64_t>(Timestamp::GetDate(stamp).days);
+		                      }
+		                      return MicroBenchmarkResult {SHEET_ROWS, SHEET_ROWS * sizeof(double)};
+	                      }});
+
+	// Number formatting (the TEXT function)
+	static const char *formats[] = {"0.00", "#,##0", "0.00%", "yyyy-mm-dd hh:mm:ss"};
+	for (const auto format_str : formats) {
+		benchmarks.push_back({"numformat/get_output_string(" + string(format_str) + ")", [format_str]() {
+			                      duckdb_excel::LocaleData locale_data;
+			                      duckdb_excel::ImpSvNumberInputScan input_scan(&locale_data);
+			                      uint16_t check_pos;
+			                      std::string format(format_str);
+			                      duckdb_excel::SvNumberformat num_format(format, &locale_data, &input_scan, check_pos);
+
+			                      static constexpr idx_t COUNT = SHEET_ROWS / 10;
+			                      std::string output;
+			                      idx_t bytes = 0;
+			                      for (idx_t i = 0; i < COUNT; i++) {
+				                      output.clear();
+				                      num_format.GetOutputString(36526.0 + static_cast<double>(i) * 1.37, output);
+				                      bytes += output.size();
+			                      }
+			                      benchmark_sink += bytes;
+			                      return MicroBenchmarkResult {COUNT, bytes};
+		                      }});
+	}
+
+	return benchmarks;
+}
+
+static int RunMicroBenchmarks(int argc, char **argv) {
+	const std::regex filter(argc > 1 ? argv[1] : ".*");
+	const idx_t repetitions = argc > 2 ? std::stoull(argv[2]) : 5;
+
+	DuckDB db(nullptr);
+	Connection con(db);
+	auto &context = *con.context;
+
+	const auto sheet_xml = GenerateSheetXML();
+	StringTable sheet_strings(BufferManager::GetBufferManager(context));
+	for (const auto &str : GenerateStrings(SHARED_STRINGS, SHARED_STRINGS)) {
+		sheet_strings.Append(str.c_str(), str.size());
+	}
+
+	for (const auto &benchmark : GetBenchmarks(context, sheet_xml, sheet_strings)) {
+		if (std::regex_search(benchmark.name, filter)) {
+			RunBenchmark(benchmark, repetitions);
+		}
+	}
+	return 0;
+}
+
+} // namespace duckdb
+
+int main(int argc, char **argv) {
+	return duckdb::RunMicroBenchmarks(argc, argv);
+}
@@ -11,6 +11,7 @@
 #include "nf_localedata.h"
 #include "nf_zformat.h"
 #include "xlsx/read_xlsx.hpp"
+#include "xlsb/read_xlsb.hpp"
 
 #include <duckdb/common/types/time.hpp>
 
@@ -85,6 +86,11 @@ void ExcelExtension::Load(DuckDB &db) {
 	// Register the XLSX functions
 	ReadXLSX::Register(db_instance);
 	WriteXLSX::Register(db_instance);
+	GenerateXLSX::Register(db_instance);
+	XLSXMetadata::Register(db_instance);
+
+	// Register the XLSB functions
+	ReadXLSB::Register(db_instance);
 }
 
 std::string ExcelExtension::Name() {
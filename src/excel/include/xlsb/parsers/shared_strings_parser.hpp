@@ -0,0 +1,130 @@
+#pragma once
+
+#include "xlsb/record_reader.hpp"
+#include "xlsx/string_table.hpp"
+
+namespace duckdb {
+
+//-------------------------------------------------------------------
+// Base Shared Strings Parser
+//-------------------------------------------------------------------
+// Base class for parsing the "sharedStrings.bin" entry of an xlsb
+// file, the binary counterpart of SharedStringParserBase. Every
+// BrtSSTItem holds a RichStr, of which we only care about the text.
+//-------------------------------------------------------------------
+class XLSBSharedStringParserBase {
+public:
+	virtual ~XLSBSharedStringParserBase() = default;
+	void ParseAll(ZipFileReader &stream);
+
+protected:
+	virtual void OnUniqueCount(idx_t count) {
+	}
+	virtual void OnString(const vector<char> &str) = 0;
+	void Stop() {
+		stopped = true;
+	}
+
+private:
+	vector<char> data;
+	bool stopped = false;
+};
+
+inline void XLSBSharedStringParserBase::ParseAll(ZipFileReader &stream) {
+	XLSBRecordReader reader(stream);
+	while (!stopped && reader.Next()) {
+		switch (reader.GetType()) {
+		case XLSBRecordType::BEGIN_SST: {
+			XLSBRecordCursor cursor(reader);
+			// cstTotal
+			cursor.Skip(4);
+			OnUniqueCount(cursor.ReadU32());
+		} break;
+		case XLSBRecordType::SST_ITEM: {
+			XLSBRecordCursor cursor(reader);
+			// The flags tell us if the string is followed by formatting runs and phonetic data, which we ignore
+			cursor.Skip(1);
+			data.clear();
+			cursor.ReadWideString(data);
+			OnString(data);
+		} break;
+		case XLSBRecordType::END_SST:
+			return;
+		default:
+			break;
+		}
+	}
+}
+
+//-------------------------------------------------------------------
+// Shared Strings Searcher
+//-------------------------------------------------------------------
+// Parses the string table for a specific set of strings
+// and returns the strings for those specific indices
+//-------------------------------------------------------------------
+class XLSBSharedStringSearcher final : public XLSBSharedStringParserBase {
+public:
+	explicit XLSBSharedStringSearcher(const vector<idx_t> &ids_p) : ids(ids_p) {
+		std::sort(ids.begin(), ids.end());
+	}
+
+	const unordered_map<idx_t, string> &GetResult() const {
+		return result;
+	}
+
+protected:
+	void OnString(const vector<char> &str) override {
+		// Skip over duplicate ids
+		while (current_idx < ids.size() && ids[current_idx] < current_str) {
+			current_idx++;
+		}
+		if (current_idx >= ids.size()) {
+			// We're done, no more strings to find
+			Stop();
+			return;
+		}
+		if (ids[current_idx] == current_str) {
+			result[current_str] = string(str.data(), str.size());
+			current_idx++;
+		}
+		current_str++;
+	}
+
+private:
+	idx_t current_idx = 0;
+	idx_t current_str = 0;
+
+	vector<idx_t> ids;
+	unordered_map<idx_t, string> result;
+};
+
+//-------------------------------------------------------------------
+// Shared Strings Parser
+//-------------------------------------------------------------------
+// Parses the string table and populates it completely. As in the
+// xlsx case the strings are unique by construction, so we append
+// them as-is instead of deduplicating them.
+//-------------------------------------------------------------------
+class XLSBSharedStringParser final : public XLSBSharedStringParserBase {
+public:
+	static void ParseStringTable(ZipFileReader &stream, StringTable &table) {
+		XLSBSharedStringParser parser(table);
+		parser.ParseAll(stream);
+	}
+
+	explicit XLSBSharedStringParser(StringTable &table_p) : table(table_p) {
+	}
+
+protected:
+	void OnString(const vector<char> &str) override {
+		table.Append(str.data(), str.size());
+	}
+	void OnUniqueCount(const idx_t count) override {
+		table.Reserve(count);
+	}
+
+private:
+	StringTable &table;
+};
+
+} // namespace duckdb
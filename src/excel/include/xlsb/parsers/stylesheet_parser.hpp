@@ -0,0 +1,69 @@
+#pragma once
+
+#include "xlsb/record_reader.hpp"
+#include "xlsx/parsers/stylesheet_parser.hpp"
+
+namespace duckdb {
+
+//-------------------------------------------------------------------
+// "xl/styles.bin" Parser
+//-------------------------------------------------------------------
+// Maps every cell format (BrtXF within BrtBeginCellXFs) to the type
+// of the values it formats, using the same rules as styles.xml.
+//-------------------------------------------------------------------
+class XLSBStyleParser {
+public:
+	static vector<LogicalType> GetCellStyles(ZipFileReader &stream) {
+		unordered_map<idx_t, LogicalType> number_formats;
+		vector<LogicalType> cell_styles;
+
+		XLSBRecordReader reader(stream);
+		string format_code;
+		bool in_cell_xfs = false;
+
+		while (reader.Next()) {
+			switch (reader.GetType()) {
+			case XLSBRecordType::FMT: {
+				XLSBRecordCursor cursor(reader);
+				const auto id = cursor.ReadU16();
+				format_code.clear();
+				if (id > 163 && cursor.ReadWideString(format_code)) {
+					number_formats.emplace(id, XLSXStyleParser::GetCustomFormatType(format_code.c_str()));
+				}
+			} break;
+			case XLSBRecordType::BEGIN_CELL_XFS:
+				in_cell_xfs = true;
+				break;
+			case XLSBRecordType::END_CELL_XFS:
+				return cell_styles;
+			case XLSBRecordType::XF: {
+				if (!in_cell_xfs) {
+					// Cell style formats, not referenced by cells directly
+					break;
+				}
+				XLSBRecordCursor cursor(reader);
+				// ixfeParent
+				cursor.Skip(2);
+				const auto id = cursor.ReadU16();
+
+				// Unlike styles.xml we push a type for every format, so that the cell style index lines up
+				LogicalType type = LogicalType::DOUBLE;
+				if (id < 164) {
+					XLSXStyleParser::TryGetBuiltinFormatType(id, type);
+				} else {
+					const auto it = number_formats.find(id);
+					if (it != number_formats.end()) {
+						type = it->second;
+					}
+				}
+				cell_styles.push_back(type);
+			} break;
+			default:
+				break;
+			}
+		}
+		return cell_styles;
+	}
+};
+
+} // namespace duckdb
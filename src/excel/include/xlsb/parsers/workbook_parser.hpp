@@ -0,0 +1,37 @@
+#pragma once
+
+#include "xlsb/record_reader.hpp"
+
+namespace duckdb {
+
+//-------------------------------------------------------------------
+// "xl/workbook.bin" Parser
+//-------------------------------------------------------------------
+// Extracts the (name, relation id) pair of every sheet from the
+// BrtBundleSh records of the workbook.
+//-------------------------------------------------------------------
+class XLSBWorkBookParser {
+public:
+	static vector<pair<string, string>> GetSheets(ZipFileReader &stream) {
+		vector<pair<string, string>> sheets;
+		XLSBRecordReader reader(stream);
+		while (reader.Next()) {
+			if (reader.GetType() != XLSBRecordType::BUNDLE_SH) {
+				continue;
+			}
+			XLSBRecordCursor cursor(reader);
+			// hsState and iTabID
+			cursor.Skip(8);
+
+			string sheet_ridx;
+			string sheet_name;
+			if (!cursor.ReadWideString(sheet_ridx) || !cursor.ReadWideString(sheet_name)) {
+				throw InvalidInputException("Invalid sheet entry in workbook.bin");
+			}
+			sheets.emplace_back(std::move(sheet_name), std::move(sheet_ridx));
+		}
+		return sheets;
+	}
+};
+
+} // namespace duckdb
@@ -0,0 +1,276 @@
+#pragma once
+
+#include "xlsb/record_reader.hpp"
+#include "xlsx/parsers/worksheet_parser.hpp"
+
+#include "fmt/format.h"
+
+#include <cmath>
+
+namespace duckdb {
+
+//-------------------------------------------------------------------
+// Worksheet Reader
+//-------------------------------------------------------------------
+// Reads the BrtRowHdr and cell records between BrtBeginSheetData and
+// BrtEndSheetData of a "sheetN.bin" entry and pushes them into one of
+// the worksheet parsers (sniffers or SheetParser) used for xlsx.
+//
+// Cell values are handed over as text, exactly as they would appear
+// in the <v> element of a xlsx sheet, so that the parsers (and the
+// casts applied to their output) behave the same for both formats.
+//-------------------------------------------------------------------
+class XLSBSheetReader {
+public:
+	explicit XLSBSheetReader(ZipFileReader &stream) : records(stream) {
+	}
+
+	// Push records into the parser until it stops, or the sheet data ends.
+	// Returns the state of the parser, once the sheet is done this is always ABORTED.
+	XMLParseResult Read(SheetParserBase &parser);
+	// Read the whole sheet, resuming the parser whenever it suspends
+	void ReadAll(SheetParserBase &parser) {
+		while (Read(parser) == XMLParseResult::SUSPENDED) {
+		}
+	}
+	// Returns the number of (inflated) bytes consumed from the sheet so far
+	idx_t GetPosition() const {
+		return records.GetPosition();
+	}
+
+private:
+	// Decode the current record into the cell buffer, returns false if it is not a cell record
+	bool ReadCell(XLSXCellPos &pos, XLSXCellType &type, idx_t &style);
+
+	static void FormatNumber(double value, vector<char> &result);
+	static void FormatInteger(int64_t value, vector<char> &result);
+	static void FormatError(uint8_t code, vector<char> &result);
+
+private:
+	XLSBRecordReader records;
+	vector<char> cell_data;
+
+	// The current (1-indexed) row
+	idx_t row_idx = 0;
+	bool in_row = false;
+	bool in_sheet_data = false;
+	bool finished = false;
+
+	// A row that we have read the header of, but couldnt begin because the parser stopped at the end of the previous
+	bool has_pending_row = false;
+	idx_t pending_row = 0;
+};
+
+inline XMLParseResult XLSBSheetReader::Read(SheetParserBase &parser) {
+	auto status = XMLParseResult::OK;
+
+	if (has_pending_row) {
+		has_pending_row = false;
+		row_idx = pending_row;
+		in_row = true;
+		status = parser.PushBeginRow(row_idx);
+		if (status != XMLParseResult::OK) {
+			return status;
+		}
+	}
+
+	while (!finished && records.Next()) {
+		const auto type = records.GetType();
+		if (!in_sheet_data) {
+			in_sheet_data = type == XLSBRecordType::BEGIN_SHEET_DATA;
+			continue;
+		}
+		if (type == XLSBRecordType::END_SHEET_DATA) {
+			break;
+		}
+
+		if (type == XLSBRecordType::ROW_HDR) {
+			XLSBRecordCursor cursor(records);
+			const auto next_row = static_cast<idx_t>(cursor.ReadU32()) + 1;
+
+			// There is no record marking the end of a row, so end the previous row here
+			if (in_row) {
+				in_row = false;
+				status = parser.PushEndRow(row_idx);
+				if (status != XMLParseResult::OK) {
+					has_pending_row = true;
+					pending_row = next_row;
+					return status;
+				}
+			}
+
+			row_idx = next_row;
+			in_row = true;
+			status = parser.PushBeginRow(row_idx);
+			if (status != XMLParseResult::OK) {
+				return status;
+			}
+			continue;
+		}
+
+		XLSXCellPos pos;
+		XLSXCellType cell_type = XLSXCellType::NUMBER;
+		idx_t cell_style = 0;
+		if (!in_row || !ReadCell(pos, cell_type, cell_style)) {
+			continue;
+		}
+		status = parser.PushCell(pos, cell_type, cell_data, cell_style);
+		if (status != XMLParseResult::OK) {
+			return status;
+		}
+	}
+
+	// We've reached the end of the sheet data, end the last row
+	finished = true;
+	if (in_row) {
+		in_row = false;
+		status = parser.PushEndRow(row_idx);
+		if (status != XMLParseResult::OK) {
+			return status;
+		}
+	}
+	return parser.PushEndSheet();
+}
+
+inline bool XLSBSheetReader::ReadCell(XLSXCellPos &pos, XLSXCellType &type, idx_t &style) {
+	const auto record_type = records.GetType();
+	switch (record_type) {
+	case XLSBRecordType::CELL_BLANK:
+	case XLSBRecordType::CELL_RK:
+	case XLSBRecordType::CELL_ERROR:
+	case XLSBRecordType::CELL_BOOL:
+	case XLSBRecordType::CELL_REAL:
+	case XLSBRecordType::CELL_ST:
+	case XLSBRecordType::CELL_ISST:
+	case XLSBRecordType::FMLA_STRING:
+	case XLSBRecordType::FMLA_NUM:
+	case XLSBRecordType::FMLA_BOOL:
+	case XLSBRecordType::FMLA_ERROR:
+	case XLSBRecordType::CELL_RSTRING:
+		break;
+	default:
+		return false;
+	}
+
+	// Every cell record starts with the (0-indexed) column, and the style index in the lower 24 bits of the next field
+	XLSBRecordCursor cursor(records);
+	pos = XLSXCellPos(row_idx, static_cast<idx_t>(cursor.ReadU32()) + 1);
+	style = cursor.ReadU32() & 0xFFFFFF;
+	cell_data.clear();
+
+	switch (record_type) {
+	case XLSBRecordType::CELL_BLANK:
+		type = XLSXCellType::NUMBER;
+		break;
+	case XLSBRecordType::CELL_RK: {
+		type = XLSXCellType::NUMBER;
+		// A RK number is either a 30 bit integer, or the upper 30 bits of a double, optionally multiplied by 100
+		const auto rk = cursor.ReadU32();
+		const auto is_int = (rk & 0x02) != 0;
+		const auto is_x100 = (rk & 0x01) != 0;
+		if (is_int && !is_x100) {
+			FormatInteger(static_cast<int32_t>(rk) >> 2, cell_data);
+			break;
+		}
+		double value;
+		if (is_int) {
+			value = static_cast<double>(static_cast<int32_t>(rk) >> 2);
+		} else {
+			const auto bits = static_cast<uint64_t>(rk & 0xFFFFFFFC) << 32;
+			memcpy(&value, &bits, sizeof(value));
+		}
+		FormatNumber(is_x100 ? value / 100 : value, cell_data);
+	} break;
+	case XLSBRecordType::CELL_REAL:
+	case XLSBRecordType::FMLA_NUM:
+		type = XLSXCellType::NUMBER;
+		FormatNumber(cursor.ReadDouble(), cell_data);
+		break;
+	case XLSBRecordType::CELL_BOOL:
+	case XLSBRecordType::FMLA_BOOL:
+		type = XLSXCellType::BOOLEAN;
+		cell_data.push_back(cursor.ReadU8() ? '1' : '0');
+		break;
+	case XLSBRecordType::CELL_ERROR:
+	case XLSBRecordType::FMLA_ERROR:
+		type = XLSXCellType::ERROR;
+		FormatError(cursor.ReadU8(), cell_data);
+		break;
+	case XLSBRecordType::CELL_ISST:
+		type = XLSXCellType::SHARED_STRING;
+		FormatInteger(cursor.ReadU32(), cell_data);
+		break;
+	case XLSBRecordType::CELL_ST:
+		type = XLSXCellType::INLINE_STRING;
+		cursor.ReadWideString(cell_data);
+		break;
+	case XLSBRecordType::CELL_RSTRING:
+		type = XLSXCellType::INLINE_STRING;
+		// Skip the RichStr flags, we dont care about the formatting runs that follow the text
+		cursor.Skip(1);
+		cursor.ReadWideString(cell_data);
+		break;
+	case XLSBRecordType::FMLA_STRING:
+		type = XLSXCellType::FORMULA_STRING;
+		cursor.ReadWideString(cell_data);
+		break;
+	default:
+		throw InternalException("Unexpected cell record type in xlsb sheet");
+	}
+	return true;
+}
+
+inline void XLSBSheetReader::FormatNumber(const double value, vector<char> &result) {
+	// Whole numbers are written without a fractional part, like Excel does when writing xlsx files
+	if (value == std::floor(value) && std::fabs(value) < 9007199254740992.0) {
+		FormatInteger(static_cast<int64_t>(value), result);
+		return;
+	}
+	// Otherwise use the shortest representation that still round-trips. Unlike printf, this does not depend on the
+	// locale, which could make the decimal separator a comma
+	char buffer[32];
+	const auto written = duckdb_fmt::format_to_n(buffer, sizeof(buffer), "{}", value);
+	result.insert(result.end(), buffer, buffer + written.size);
+}
+
+inline void XLSBSheetReader::FormatInteger(const int64_t value, vector<char> &result) {
+	char buffer[24];
+	const auto written = duckdb_fmt::format_to_n(buffer, sizeof(buffer), "{}", value);
+	result.insert(result.end(), buffer, buffer + written.size);
+}
+
+inline void XLSBSheetReader::FormatError(const uint8_t code, vector<char> &result) {
+	const char *error;
+	switch (code) {
+	case 0x00:
+		error = "#NULL!";
+		break;
+	case 0x07:
+		error = "#DIV/0!";
+		break;
+	case 0x0F:
+		error = "#VALUE!";
+		break;
+	case 0x17:
+		error = "#REF!";
+		break;
+	case 0x1D:
+		error = "#NAME?";
+		break;
+	case 0x24:
+		error = "#NUM!";
+		break;
+	case 0x2A:
+		error = "#N/A";
+		break;
+	case 0x2B:
+		error = "#GETTING_DATA";
+		break;
+	default:
+		error = "#ERROR!";
+		break;
+	}
+	result.insert(result.end(), error, error + strlen(error));
+}
+
+} // namespace duckdb
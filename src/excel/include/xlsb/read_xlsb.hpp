@@ -0,0 +1,13 @@
+#pragma once
+#include "duckdb/function/table_function.hpp"
+
+namespace duckdb {
+
+class DatabaseInstance;
+
+struct ReadXLSB {
+	static void Register(DatabaseInstance &db);
+	static TableFunction GetFunction();
+};
+
+} // namespace duckdb
@@ -0,0 +1,270 @@
+#pragma once
+
+#include "xlsx/zip_file.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/helper.hpp"
+#include "duckdb/common/vector.hpp"
+
+namespace duckdb {
+
+//-------------------------------------------------------------------
+// BIFF12 Records
+//-------------------------------------------------------------------
+// The parts of an xlsb workbook are streams of BIFF12 records. Every
+// record starts with a variable length type (1-2 bytes) and size (1-4
+// bytes), 7 bits per byte with the high bit marking continuation,
+// followed by the record payload. Only the records we care about are
+// listed here, see [MS-XLSB] 2.3 for the full list.
+//-------------------------------------------------------------------
+
+enum class XLSBRecordType : uint16_t {
+	ROW_HDR = 0,
+	CELL_BLANK = 1,
+	CELL_RK = 2,
+	CELL_ERROR = 3,
+	CELL_BOOL = 4,
+	CELL_REAL = 5,
+	CELL_ST = 6,
+	CELL_ISST = 7,
+	FMLA_STRING = 8,
+	FMLA_NUM = 9,
+	FMLA_BOOL = 10,
+	FMLA_ERROR = 11,
+	SST_ITEM = 19,
+	FMT = 44,
+	XF = 47,
+	CELL_RSTRING = 62,
+	BEGIN_SHEET_DATA = 145,
+	END_SHEET_DATA = 146,
+	BUNDLE_SH = 156,
+	BEGIN_SST = 159,
+	END_SST = 160,
+	BEGIN_CELL_XFS = 617,
+	END_CELL_XFS = 618,
+};
+
+//-------------------------------------------------------------------
+// Record Reader
+//-------------------------------------------------------------------
+// Reads records from the currently open entry of a zip archive.
+//-------------------------------------------------------------------
+class XLSBRecordReader {
+public:
+	explicit XLSBRecordReader(ZipFileReader &stream_p)
+	    : stream(stream_p), buffer(make_unsafe_uniq_array_uninitialized<data_t>(BUFFER_SIZE)) {
+	}
+
+	// Read the next record, returns false once the entry is exhausted
+	bool Next();
+
+	XLSBRecordType GetType() const {
+		return static_cast<XLSBRecordType>(type);
+	}
+	const_data_ptr_t GetData() const {
+		return record.data();
+	}
+	idx_t GetSize() const {
+		return record.size();
+	}
+
+	// Returns the number of (inflated) bytes consumed from the entry so far
+	idx_t GetPosition() const {
+		return stream_pos - (buffer_len - buffer_pos);
+	}
+
+private:
+	bool ReadByte(data_t &result);
+	bool ReadVarInt(idx_t max_bytes, idx_t &result);
+	void ReadBytes(data_ptr_t ptr, idx_t len);
+
+private:
+	ZipFileReader &stream;
+	unsafe_unique_array<data_t> buffer;
+	idx_t buffer_pos = 0;
+	idx_t buffer_len = 0;
+	idx_t stream_pos = 0;
+
+	idx_t type = 0;
+	vector<data_t> record;
+
+	static constexpr auto BUFFER_SIZE = 8192;
+	// The maximum record size is limited by the 4 byte size field
+	static constexpr auto MAX_RECORD_SIZE = (1ULL << 28) - 1;
+};
+
+inline bool XLSBRecordReader::ReadByte(data_t &result) {
+	if (buffer_pos == buffer_len) {
+		if (stream.IsDone()) {
+			return false;
+		}
+		buffer_len = stream.Read(char_ptr_cast(buffer.get()), BUFFER_SIZE);
+		buffer_pos = 0;
+		stream_pos += buffer_len;
+		if (buffer_len == 0) {
+			return false;
+		}
+	}
+	result = buffer[buffer_pos++];
+	return true;
+}
+
+inline bool XLSBRecordReader::ReadVarInt(const idx_t max_bytes, idx_t &result) {
+	result = 0;
+	for (idx_t i = 0; i < max_bytes; i++) {
+		data_t byte;
+		if (!ReadByte(byte)) {
+			return false;
+		}
+		result |= static_cast<idx_t>(byte & 0x7F) << (7 * i);
+		if ((byte & 0x80) == 0) {
+			break;
+		}
+	}
+	return true;
+}
+
+inline void XLSBRecordReader::ReadBytes(data_ptr_t ptr, idx_t len) {
+	while (len > 0) {
+		if (buffer_pos == buffer_len) {
+			if (stream.IsDone()) {
+				throw InvalidInputException("XLSB: Unexpected end of record (is the file corrupted?)");
+			}
+			buffer_len = stream.Read(char_ptr_cast(buffer.get()), BUFFER_SIZE);
+			buffer_pos = 0;
+			stream_pos += buffer_len;
+			if (buffer_len == 0) {
+				throw InvalidInputException("XLSB: Unexpected end of record (is the file corrupted?)");
+			}
+		}
+		const auto copy_len = MinValue(len, buffer_len - buffer_pos);
+		memcpy(ptr, buffer.get() + buffer_pos, copy_len);
+		buffer_pos += copy_len;
+		ptr += copy_len;
+		len -= copy_len;
+	}
+}
+
+inline bool XLSBRecordReader::Next() {
+	idx_t size;
+	if (!ReadVarInt(2, type)) {
+		return false;
+	}
+	if (!ReadVarInt(4, size)) {
+		throw InvalidInputException("XLSB: Unexpected end of record (is the file corrupted?)");
+	}
+	if (size > MAX_RECORD_SIZE) {
+		throw InvalidInputException("XLSB: Record too large (is the file corrupted?)");
+	}
+	record.resize(size);
+	ReadBytes(record.data(), size);
+	return true;
+}
+
+//-------------------------------------------------------------------
+// Record Cursor
+//-------------------------------------------------------------------
+// Reads the (little endian) fields of a single record payload.
+//-------------------------------------------------------------------
+class XLSBRecordCursor {
+public:
+	explicit XLSBRecordCursor(const XLSBRecordReader &reader)
+	    : ptr(reader.GetData()), end(reader.GetData() + reader.GetSize()) {
+	}
+
+	uint8_t ReadU8() {
+		return Read<uint8_t>();
+	}
+	uint16_t ReadU16() {
+		return Read<uint16_t>();
+	}
+	uint32_t ReadU32() {
+		return Read<uint32_t>();
+	}
+	double ReadDouble() {
+		return Read<double>();
+	}
+	void Skip(idx_t len) {
+		Check(len);
+		ptr += len;
+	}
+
+	// Read a XLWideString (a 4 byte character count followed by UTF-16 characters) and append it as UTF-8.
+	// Returns false if the string is a XLNullableWideString that is null.
+	bool ReadWideString(vector<char> &result);
+	bool ReadWideString(string &result);
+
+private:
+	void Check(const idx_t len) const {
+		if (len > static_cast<idx_t>(end - ptr)) {
+			throw InvalidInputException("XLSB: Record too short (is the file corrupted?)");
+		}
+	}
+	template <class T>
+	T Read() {
+		Check(sizeof(T));
+		T result;
+		memcpy(&result, ptr, sizeof(T));
+		ptr += sizeof(T);
+		return result;
+	}
+	template <class BUFFER>
+	bool ReadWideStringInternal(BUFFER &result);
+
+private:
+	const_data_ptr_t ptr;
+	const_data_ptr_t end;
+};
+
+template <class BUFFER>
+bool XLSBRecordCursor::ReadWideStringInternal(BUFFER &result) {
+	const auto count = ReadU32();
+	if (count == 0xFFFFFFFF) {
+		return false;
+	}
+	Check(count * 2ULL);
+
+	const auto chars = ptr;
+	ptr += count * 2ULL;
+
+	for (idx_t i = 0; i < count; i++) {
+		uint32_t cp = Load<uint16_t>(chars + i * 2);
+		if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < count) {
+			// Combine surrogate pairs
+			const uint32_t low = Load<uint16_t>(chars + (i + 1) * 2);
+			if (low >= 0xDC00 && low <= 0xDFFF) {
+				cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+				i++;
+			}
+		}
+		if (cp >= 0xD800 && cp <= 0xDFFF) {
+			// Unpaired surrogates can't be represented in UTF-8
+			cp = 0xFFFD;
+		}
+		if (cp < 0x80) {
+			result.push_back(static_cast<char>(cp));
+		} else if (cp < 0x800) {
+			result.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+			result.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+		} else if (cp < 0x10000) {
+			result.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+			result.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+			result.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+		} else {
+			result.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+			result.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+			result.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+			result.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+		}
+	}
+	return true;
+}
+
+inline bool XLSBRecordCursor::ReadWideString(vector<char> &result) {
+	return ReadWideStringInternal(result);
+}
+
+inline bool XLSBRecordCursor::ReadWideString(string &result) {
+	return ReadWideStringInternal(result);
+}
+
+} // namespace duckdb
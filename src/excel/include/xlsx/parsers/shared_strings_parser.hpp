@@ -3,6 +3,11 @@
 #include "xlsx/xml_parser.hpp"
 #include "xlsx/string_table.hpp"
 
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/parallel/task_executor.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+
 namespace duckdb {
 
 //-------------------------------------------------------------------
@@ -137,29 +142,212 @@ private:
 // Shared Strings Parser
 //-------------------------------------------------------------------
 // Parses the string table and populate it completely
-// with all the strings found in the file
+// with all the strings found in the file. The strings in the
+// table are unique by construction, so we append them as-is
+// instead of deduplicating them.
 //-------------------------------------------------------------------
 class SharedStringParser final : public SharedStringParserBase {
 public:
 	static void ParseStringTable(ZipFileReader &stream, StringTable &table) {
-		SharedStringParser parser(table);
+		SharedStringParser parser(table, true);
 		parser.ParseAll(stream);
 	}
 
-private:
-	explicit SharedStringParser(StringTable &table_p) : table(table_p) {
+	// Whether an entry of this size is large enough to parse in parallel. Parsing in parallel inflates the whole
+	// entry into memory first, so the caller has to account for another entry_len bytes of memory
+	static bool CanParseInParallel(ClientContext &context, idx_t entry_len);
+	// Parse the string table using multiple threads if allowed and the entry is large enough
+	static void ParseStringTable(ClientContext &context, ZipFileReader &stream, StringTable &table, bool parallel);
+
+	// Parse a <si> aligned segment of the inflated string table, wrapping it in <sst> tags if needed
+	void ParseSegment(const char *segment, idx_t len, bool open_sst, bool close_sst);
+
+	explicit SharedStringParser(StringTable &table_p, bool reserve_p) : table(table_p), reserve(reserve_p) {
+	}
+
+	idx_t GetUniqueCount() const {
+		return unique_count;
 	}
 
 protected:
 	void OnString(const vector<char> &str) override {
-		table.Add(string_t(str.data(), str.size()));
+		table.Append(str.data(), str.size());
 	}
 	void OnUniqueCount(const idx_t count) override {
-		table.Reserve(count);
+		unique_count = count;
+		if (reserve) {
+			table.Reserve(count);
+		}
+	}
+
+private:
+	StringTable &table;
+	bool reserve;
+	idx_t unique_count = 0;
+};
+
+inline void SharedStringParser::ParseSegment(const char *segment, const idx_t len, const bool open_sst,
+                                             const bool close_sst) {
+	static constexpr auto SST_OPEN = "<sst>";
+	static constexpr auto SST_CLOSE = "</sst>";
+
+	if (open_sst) {
+		Parse(SST_OPEN, strlen(SST_OPEN), false);
+	}
+	Parse(segment, len, !close_sst);
+	if (close_sst) {
+		Parse(SST_CLOSE, strlen(SST_CLOSE), true);
+	}
+}
+
+//-------------------------------------------------------------------
+// Parallel Shared Strings Parser
+//-------------------------------------------------------------------
+// Large string tables are inflated in full, split at <si> boundaries
+// and parsed into one StringTable per segment on the task scheduler.
+// The segments are then concatenated in order, so that the string
+// indices match the ones we would get from parsing the table serially.
+//-------------------------------------------------------------------
+
+// Find the start of the next <si> element at or after the given position
+inline idx_t FindSharedStringStart(const char *data, idx_t pos, const idx_t end) {
+	while (pos < end) {
+		const auto tag = static_cast<const char *>(memchr(data + pos, '<', end - pos));
+		if (!tag) {
+			break;
+		}
+		pos = UnsafeNumericCast<idx_t>(tag - data);
+
+		// Extract the tag name, and strip any namespace prefix
+		auto name_beg = pos + 1;
+		auto name_end = name_beg;
+		while (name_end < end && !StringUtil::CharacterIsSpace(data[name_end]) && data[name_end] != '>' &&
+		       data[name_end] != '/') {
+			if (data[name_end] == ':') {
+				name_beg = name_end + 1;
+			}
+			name_end++;
+		}
+		if (name_end - name_beg == 2 && data[name_beg] == 's' && data[name_beg + 1] == 'i') {
+			return pos;
+		}
+		pos++;
+	}
+	return DConstants::INVALID_INDEX;
+}
+
+class SharedStringSegmentTask final : public BaseExecutorTask {
+public:
+	SharedStringSegmentTask(TaskExecutor &executor, const char *segment_p, idx_t len_p, bool open_sst_p,
+	                        bool close_sst_p, StringTable &table_p, idx_t estimated_count_p)
+	    : BaseExecutorTask(executor), segment(segment_p), len(len_p), open_sst(open_sst_p), close_sst(close_sst_p),
+	      table(table_p), estimated_count(estimated_count_p) {
+	}
+
+	void ExecuteTask() override {
+		table.Reserve(estimated_count);
+		SharedStringParser parser(table, false);
+		parser.ParseSegment(segment, len, open_sst, close_sst);
 	}
 
 private:
+	const char *segment;
+	idx_t len;
+	bool open_sst;
+	bool close_sst;
 	StringTable &table;
+	idx_t estimated_count;
 };
 
+// Only bother splitting up the string table if there is enough work to go around
+static constexpr idx_t SHARED_STRINGS_MIN_SEGMENT_SIZE = 4 * 1024 * 1024;
+
+inline idx_t GetSharedStringSegmentCount(ClientContext &context, const idx_t entry_len) {
+	const auto thread_count = NumericCast<idx_t>(TaskScheduler::GetScheduler(context).NumberOfThreads());
+	return MinValue<idx_t>(thread_count, entry_len / SHARED_STRINGS_MIN_SEGMENT_SIZE);
+}
+
+inline bool SharedStringParser::CanParseInParallel(ClientContext &context, const idx_t entry_len) {
+	return GetSharedStringSegmentCount(context, entry_len) > 1;
+}
+
+inline void SharedStringParser::ParseStringTable(ClientContext &context, ZipFileReader &stream, StringTable &table,
+                                                 const bool parallel) {
+	const auto entry_len = stream.GetEntryLen();
+	const auto max_segments = GetSharedStringSegmentCount(context, entry_len);
+	// If we are short on memory, stream the entry instead of inflating it all at once
+	if (!parallel || max_segments <= 1 || table.IsSpillable()) {
+		ParseStringTable(stream, table);
+		return;
+	}
+
+	// Inflate the whole entry into memory
+	auto &allocator = BufferAllocator::Get(context);
+	auto buffer = allocator.Allocate(entry_len);
+	const auto data = char_ptr_cast(buffer.get());
+
+	idx_t data_len = 0;
+	while (!stream.IsDone()) {
+		const auto read_size = MinValue<idx_t>(entry_len - data_len, NumericLimits<int32_t>::Maximum());
+		const auto bytes_read = stream.Read(data + data_len, read_size);
+		if (bytes_read == 0) {
+			throw IOException("Failed to read shared strings from xlsx file (is the file corrupt?)");
+		}
+		data_len += bytes_read;
+	}
+
+	// Everything before the first <si> is the header, which we parse serially to get the unique count
+	const auto body_beg = FindSharedStringStart(data, 0, data_len);
+	if (body_beg == DConstants::INVALID_INDEX) {
+		// No strings (or something we dont understand), just parse the whole thing serially
+		SharedStringParser parser(table, true);
+		parser.ParseSegment(data, data_len, false, false);
+		return;
+	}
+
+	SharedStringParser header_parser(table, false);
+	header_parser.ParseSegment(data, body_beg, false, true);
+	const auto unique_count = header_parser.GetUniqueCount();
+
+	// Cut the body into segments of roughly equal size, aligned to <si> elements
+	vector<idx_t> cuts;
+	cuts.push_back(body_beg);
+	const auto segment_size = (data_len - body_beg) / max_segments;
+	for (idx_t i = 1; i < max_segments; i++) {
+		const auto cut = FindSharedStringStart(data, MaxValue(body_beg + i * segment_size, cuts.back() + 1), data_len);
+		if (cut == DConstants::INVALID_INDEX) {
+			break;
+		}
+		cuts.push_back(cut);
+	}
+	cuts.push_back(data_len);
+
+	// Parse every segment into its own table
+	const auto segment_count = cuts.size() - 1;
+	vector<unique_ptr<StringTable>> segments;
+	TaskExecutor executor(context);
+	for (idx_t i = 0; i < segment_count; i++) {
+		const auto beg = cuts[i];
+		const auto len = cuts[i + 1] - beg;
+		const auto is_last = i + 1 == segment_count;
+		// Estimate the amount of strings in this segment based on its share of the body
+		const auto estimated_count = unique_count * len / (data_len - body_beg);
+
+		segments.push_back(make_uniq<StringTable>(BufferManager::GetBufferManager(context)));
+		executor.ScheduleTask(make_uniq<SharedStringSegmentTask>(executor, data + beg, len, true, !is_last,
+		                                                         *segments.back(), estimated_count));
+	}
+	executor.WorkOnTasks();
+
+	// Now concatenate the segments in order
+	idx_t total_count = table.Count();
+	for (auto &segment : segments) {
+		total_count += segment->Count();
+	}
+	table.Reserve(total_count);
+	for (auto &segment : segments) {
+		table.Append(*segment);
+	}
+}
+
 } // namespace duckdb
\ No newline at end of file
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "xlsx/xml_parser.hpp"
 
 namespace duckdb {
@@ -7,6 +9,11 @@ public:
 	unordered_map<idx_t, LogicalType> number_formats;
 	vector<LogicalType> cell_styles;
 
+	// Get the type of the values formatted by a custom number format (id >= 164)
+	static LogicalType GetCustomFormatType(const char *format_code);
+	// Get the type of the values formatted by a builtin number format (id < 164), false if it is not temporal
+	static bool TryGetBuiltinFormatType(idx_t id, LogicalType &result);
+
 protected:
 	void OnStartElement(const char *name, const char **atts) override;
 	void OnEndElement(const char *name) override;
@@ -25,6 +32,36 @@ private:
 	State state = State::START;
 };
 
+inline LogicalType XLSXStyleParser::GetCustomFormatType(const char *format_code) {
+	const auto has_date_part = StringContainsAny(format_code, "DD", "dd", "YY", "yy");
+	const auto has_time_part = StringContainsAny(format_code, "HH", "hh", "h", "H");
+
+	if (has_date_part && has_time_part) {
+		return LogicalType::TIMESTAMP;
+	}
+	if (has_date_part) {
+		return LogicalType::DATE;
+	}
+	if (has_time_part) {
+		return LogicalType::TIME;
+	}
+	// If we dont know how to handle the format, default to the numeric value.
+	return LogicalType::DOUBLE; // TODO: Or double?
+}
+
+inline bool XLSXStyleParser::TryGetBuiltinFormatType(const idx_t id, LogicalType &result) {
+	if (id >= 14 && id <= 17) {
+		result = LogicalType::DATE;
+	} else if (id >= 18 && id <= 21) {
+		result = LogicalType::TIME;
+	} else if (id == 22) {
+		result = LogicalType::TIMESTAMP;
+	} else {
+		return false;
+	}
+	return true;
+}
+
 inline void XLSXStyleParser::OnStartElement(const char *name, const char **atts) {
 	switch (state) {
 	case State::START:
@@ -59,20 +96,7 @@ inline void XLSXStyleParser::OnStartElement(const char *name, const char **atts)
 		if (id <= 163 || format_ptr == nullptr) {
 			break;
 		}
-
-		const auto has_date_part = StringContainsAny(format_ptr, "DD", "dd", "YY", "yy");
-		const auto has_time_part = StringContainsAny(format_ptr, "HH", "hh", "h", "H");
-
-		if (has_date_part && has_time_part) {
-			number_formats.emplace(id, LogicalType::TIMESTAMP);
-		} else if (has_date_part) {
-			number_formats.emplace(id, LogicalType::DATE);
-		} else if (has_time_part) {
-			number_formats.emplace(id, LogicalType::TIME);
-		} else {
-			// If we dont know how to handle the format, default to the numeric value.
-			number_formats.emplace(id, LogicalType::DOUBLE); // TODO: Or double?
-		}
+		number_formats.emplace(id, GetCustomFormatType(format_ptr));
 	} break;
 	case State::CELLXFS: {
 		state = State::XF;
@@ -89,12 +113,9 @@ inline void XLSXStyleParser::OnStartElement(const char *name, const char **atts)
 		const auto id = strtol(id_ptr, nullptr, 10);
 		if (id < 164) {
 			// Special cases
-			if (id >= 14 && id <= 17) {
-				cell_styles.push_back(LogicalType::DATE);
-			} else if (id >= 18 && id <= 21) {
-				cell_styles.push_back(LogicalType::TIME);
-			} else if (id == 22) {
-				cell_styles.push_back(LogicalType::TIMESTAMP);
+			LogicalType type;
+			if (TryGetBuiltinFormatType(id, type)) {
+				cell_styles.push_back(type);
 			}
 		} else {
 			// Look up the ID in the format map
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "xlsx/xml_parser.hpp"
+
+namespace duckdb {
+
+//-------------------------------------------------------------------
+// "xl/tables/tableN.xml" Parser
+//-------------------------------------------------------------------
+// Parses the definition of an Excel table (a "ListObject"), which
+// covers a fixed range of a sheet, optionally with a header row and
+// a totals row, and lists the names of its columns.
+//-------------------------------------------------------------------
+
+struct XLSXTable {
+	string name;
+	string display_name;
+	string ref;
+	idx_t header_row_count = 1;
+	idx_t totals_row_count = 0;
+	vector<string> columns;
+};
+
+class TableParser final : public XMLParser {
+public:
+	static XLSXTable ParseTable(ZipFileReader &stream) {
+		TableParser parser;
+		parser.ParseAll(stream);
+		return std::move(parser.table);
+	}
+
+private:
+	void OnStartElement(const char *name, const char **atts) override;
+	void OnEndElement(const char *name) override;
+
+private:
+	enum class State : uint8_t { START, TABLE, COLUMNS };
+	State state = State::START;
+	XLSXTable table;
+};
+
+inline void TableParser::OnStartElement(const char *name, const char **atts) {
+	switch (state) {
+	case State::START:
+		if (MatchTag("table", name)) {
+			state = State::TABLE;
+			for (idx_t i = 0; atts[i]; i += 2) {
+				if (strcmp(atts[i], "name") == 0) {
+					table.name = atts[i + 1];
+				} else if (strcmp(atts[i], "displayName") == 0) {
+					table.display_name = atts[i + 1];
+				} else if (strcmp(atts[i], "ref") == 0) {
+					table.ref = atts[i + 1];
+				} else if (strcmp(atts[i], "headerRowCount") == 0) {
+					table.header_row_count = std::strtoul(atts[i + 1], nullptr, 10);
+				} else if (strcmp(atts[i], "totalsRowCount") == 0) {
+					table.totals_row_count = std::strtoul(atts[i + 1], nullptr, 10);
+				}
+			}
+		}
+		break;
+	case State::TABLE:
+		if (MatchTag("tableColumns", name)) {
+			state = State::COLUMNS;
+		}
+		break;
+	case State::COLUMNS:
+		if (MatchTag("tableColumn", name)) {
+			const char *column_name = nullptr;
+			for (idx_t i = 0; atts[i]; i += 2) {
+				if (strcmp(atts[i], "name") == 0) {
+					column_name = atts[i + 1];
+				}
+			}
+			if (!column_name) {
+				throw InvalidInputException("Invalid table column entry in table definition");
+			}
+			table.columns.emplace_back(column_name);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+inline void TableParser::OnEndElement(const char *name) {
+	if (state == State::COLUMNS && MatchTag("tableColumns", name)) {
+		// Thats all we need
+		Stop(false);
+	}
+}
+
+} // namespace duckdb
@@ -1,23 +1,40 @@
 #pragma once
 
 #include "xlsx/xml_parser.hpp"
+#include "duckdb/common/optional_idx.hpp"
 
 namespace duckdb {
 
+struct XLSXDefinedName {
+	string name;
+	// The formula the name refers to, e.g. "'My Sheet'!$A$1:$C$10"
+	string formula;
+	// The position of the sheet the name is scoped to, unless it is scoped to the whole workbook
+	optional_idx local_sheet_id;
+};
+
 //-------------------------------------------------------------------
 // "xl/workbook.xml" Parser
 //-------------------------------------------------------------------
 class WorkBookParser final : public XMLParser {
 public:
+	// Returns the (name, relation id) pairs of the sheets
 	static vector<pair<string, string>> GetSheets(ZipFileReader &stream) {
 		WorkBookParser parser;
 		parser.ParseAll(stream);
 		return std::move(parser.sheets);
 	}
+	// Returns the defined names, in order
+	static vector<XLSXDefinedName> GetDefinedNames(ZipFileReader &stream) {
+		WorkBookParser parser;
+		parser.ParseAll(stream);
+		return std::move(parser.defined_names);
+	}
 
 private:
 	void OnStartElement(const char *name, const char **atts) override;
 	void OnEndElement(const char *name) override;
+	void OnText(const char *text, idx_t len) override;
 
 private:
 	enum class State {
@@ -25,9 +42,12 @@ private:
 		WORKBOOK,
 		SHEETS,
 		SHEET,
+		DEFINED_NAMES,
+		DEFINED_NAME,
 	};
 	State state = State::START;
 	vector<pair<string, string>> sheets;
+	vector<XLSXDefinedName> defined_names;
 };
 
 inline void WorkBookParser::OnStartElement(const char *name, const char **atts) {
@@ -40,6 +60,28 @@ inline void WorkBookParser::OnStartElement(const char *name, const char **atts)
 	case State::WORKBOOK:
 		if (MatchTag("sheets", name)) {
 			state = State::SHEETS;
+		} else if (MatchTag("definedNames", name)) {
+			state = State::DEFINED_NAMES;
+		}
+		break;
+	case State::DEFINED_NAMES:
+		if (MatchTag("definedName", name)) {
+			state = State::DEFINED_NAME;
+			XLSXDefinedName defined_name;
+			auto has_name = false;
+			for (idx_t i = 0; atts[i]; i += 2) {
+				if (strcmp(atts[i], "name") == 0) {
+					defined_name.name = atts[i + 1];
+					has_name = true;
+				} else if (strcmp(atts[i], "localSheetId") == 0) {
+					defined_name.local_sheet_id = std::strtoull(atts[i + 1], nullptr, 10);
+				}
+			}
+			if (!has_name) {
+				throw InvalidInputException("Invalid defined name entry in workbook.xml");
+			}
+			defined_names.push_back(std::move(defined_name));
+			EnableTextHandler(true);
 		}
 		break;
 	case State::SHEETS:
@@ -79,6 +121,17 @@ inline void WorkBookParser::OnEndElement(const char *name) {
 			state = State::WORKBOOK;
 		}
 		break;
+	case State::DEFINED_NAME:
+		if (MatchTag("definedName", name)) {
+			state = State::DEFINED_NAMES;
+			EnableTextHandler(false);
+		}
+		break;
+	case State::DEFINED_NAMES:
+		if (MatchTag("definedNames", name)) {
+			state = State::WORKBOOK;
+		}
+		break;
 	case State::WORKBOOK:
 		if (MatchTag("workbook", name)) {
 			Stop(false);
@@ -89,4 +142,9 @@ inline void WorkBookParser::OnEndElement(const char *name) {
 	}
 }
 
+inline void WorkBookParser::OnText(const char *text, idx_t len) {
+	D_ASSERT(state == State::DEFINED_NAME);
+	defined_names.back().formula.append(text, len);
+}
+
 } // namespace duckdb
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "xlsx/xml_parser.hpp"
+#include "xlsx/string_table.hpp"
 
 namespace duckdb {
 
@@ -16,6 +17,29 @@ public:
 	void OnStartElement(const char *name, const char **atts) override;
 	void OnEndElement(const char *name) override;
 
+	// Push rows and cells directly, for sheet formats that are not XML (e.g. xlsb).
+	// Returns the state of the parser afterwards, just like Parse() and Resume()
+	XMLParseResult PushBeginRow(idx_t row_idx);
+	XMLParseResult PushEndRow(idx_t row_idx);
+	XMLParseResult PushCell(const XLSXCellPos &pos, XLSXCellType type, vector<char> &data, idx_t style);
+	XMLParseResult PushEndSheet();
+
+	// Statistics, for profiling
+	idx_t GetElementCount() const {
+		return element_count;
+	}
+	idx_t GetRowCount() const {
+		return row_count;
+	}
+	idx_t GetCellCount() const {
+		return cell_count;
+	}
+	// The "ref" of the <dimension> element preceding the sheet data, if any (e.g. "A1:D100").
+	// This is written by the producer of the file and might not be accurate, so only use it as an estimate
+	const string &GetDimension() const {
+		return dimension;
+	}
+
 protected:
 	virtual void OnBeginRow(idx_t row_idx) {};
 	virtual void OnEndRow(idx_t row_idx) {};
@@ -30,6 +54,12 @@ private:
 	XLSXCellType cell_type = XLSXCellType::NUMBER;
 	vector<char> cell_data = {};
 	idx_t cell_style = 0;
+
+	idx_t element_count = 0;
+	idx_t row_count = 0;
+	idx_t cell_count = 0;
+
+	string dimension;
 };
 
 inline void SheetParserBase::OnText(const char *text, idx_t len) {
@@ -41,8 +71,15 @@ inline void SheetParserBase::OnText(const char *text, idx_t len) {
 }
 
 inline void SheetParserBase::OnStartElement(const char *name, const char **atts) {
+	element_count++;
 	if (state == State::START && MatchTag("sheetData", name)) {
 		state = State::SHEETDATA;
+	} else if (state == State::START && MatchTag("dimension", name)) {
+		for (idx_t i = 0; atts[i]; i += 2) {
+			if (strcmp(atts[i], "ref") == 0) {
+				dimension = atts[i + 1];
+			}
+		}
 	} else if (state == State::SHEETDATA && MatchTag("row", name)) {
 		state = State::ROW;
 
@@ -64,6 +101,7 @@ inline void SheetParserBase::OnStartElement(const char *name, const char **atts)
 			cell_pos.row = strtol(rref_ptr, nullptr, 10);
 		}
 
+		row_count++;
 		OnBeginRow(cell_pos.row);
 	} else if (state == State::ROW && MatchTag("c", name)) {
 		state = State::CELL;
@@ -120,6 +158,7 @@ inline void SheetParserBase::OnEndElement(const char *name) {
 		OnEndRow(cell_pos.row);
 		state = State::SHEETDATA;
 	} else if (state == State::CELL && MatchTag("c", name)) {
+		cell_count++;
 		OnCell(cell_pos, cell_type, cell_data, cell_style);
 		state = State::ROW;
 	} else if (state == State::V && MatchTag("v", name)) {
@@ -133,6 +172,35 @@ inline void SheetParserBase::OnEndElement(const char *name) {
 	}
 }
 
+inline XMLParseResult SheetParserBase::PushBeginRow(const idx_t row_idx) {
+	if (BeginPush()) {
+		row_count++;
+		OnBeginRow(row_idx);
+	}
+	return GetState();
+}
+
+inline XMLParseResult SheetParserBase::PushEndRow(const idx_t row_idx) {
+	if (BeginPush()) {
+		OnEndRow(row_idx);
+	}
+	return GetState();
+}
+
+inline XMLParseResult SheetParserBase::PushCell(const XLSXCellPos &pos, const XLSXCellType type, vector<char> &data,
+                                                const idx_t style) {
+	if (BeginPush()) {
+		cell_count++;
+		OnCell(pos, type, data, style);
+	}
+	return GetState();
+}
+
+inline XMLParseResult SheetParserBase::PushEndSheet() {
+	Stop(false);
+	return GetState();
+}
+
 //-------------------------------------------------------------------
 // Range Sniffer
 //-------------------------------------------------------------------
@@ -143,6 +211,10 @@ inline void SheetParserBase::OnEndElement(const char *name) {
 class RangeSniffer final : public SheetParserBase {
 public:
 	XLSXCellRange GetRange() const;
+	// Returns true if no row with data was found
+	bool IsEmpty() const {
+		return beg_row == 0;
+	}
 
 private:
 	void OnEndRow(idx_t row_idx) override;
@@ -365,12 +437,20 @@ class SheetParser final : public SheetParserBase {
 public:
 	explicit SheetParser(ClientContext &context, const XLSXCellRange &range_p, const StringTable &table,
 	                     bool stop_at_empty_p)
-	    : string_table(table), range(range_p), stop_at_empty(stop_at_empty_p) {
+	    : string_table(table), range(range_p), allocator(BufferAllocator::Get(context)),
+	      null_vector(Value(LogicalType::VARCHAR)), stop_at_empty(stop_at_empty_p) {
 
-		// Initialize the chunk
+		// Initialize the chunk without allocating any vectors.
+		// Vectors are only allocated for columns that actually receive data (see GetColumn)
 		const vector<LogicalType> types(range.Width(), LogicalType::VARCHAR);
-		auto &buffer_alloc = BufferAllocator::Get(context);
-		chunk.Initialize(buffer_alloc, types);
+		chunk.InitializeEmpty(types);
+		for (auto &col : chunk.data) {
+			col.Reference(null_vector);
+		}
+		column_caches.resize(range.Width());
+		column_active.resize(range.Width(), false);
+		track_numbers.resize(range.Width(), false);
+		number_cells.resize(range.Width());
 
 		// Set the beginning column
 		// Allocate the sheet row number mapping
@@ -378,12 +458,16 @@ public:
 
 		last_row = range.beg.row - 1;
 		curr_row = range.beg.row;
-		last_col = range.beg.col - 1;
+
+		column_blocks.resize(range.Width(), DConstants::INVALID_INDEX);
+		ResetChunk();
 	}
 
 	DataChunk &GetChunk() {
 		return chunk;
 	}
+	// Reset the chunk, and release any string table blocks pinned for it
+	void ResetChunk();
 	string GetCellName(idx_t chunk_row, idx_t chunk_col) const;
 
 	// Returns true if the chunk is full
@@ -392,25 +476,51 @@ public:
 	// Fill empty rows to the end of the range
 	void FillRows();
 
+	// Keep track of which cells of the column hold numbers, as opposed to text, booleans etc.
+	void TrackNumberCells(idx_t col_idx);
+	// The rows of the current chunk with a number in this column, only valid if the column is tracked and has data
+	const ValidityMask &GetNumberCells(idx_t col_idx) const {
+		D_ASSERT(track_numbers[col_idx]);
+		return number_cells[col_idx];
+	}
+
 protected:
 	void OnBeginRow(idx_t row_idx) override;
 	void OnEndRow(idx_t row_idx) override;
 	void OnCell(const XLSXCellPos &pos, XLSXCellType type, vector<char> &data, idx_t style) override;
 
+private:
+	string_t GetSharedString(Vector &vec, idx_t col_idx, const char *ssi_str);
+	// Get the vector for a column, allocating it if this is the first cell in the column of this chunk
+	Vector &GetColumn(idx_t col_idx);
+
 private:
 	// Shared String Table
 	const StringTable &string_table;
+	// If the string table is spillable, the blocks we have pinned for the current chunk
+	unordered_map<idx_t, buffer_ptr<StringTablePin>> pinned_blocks;
+	// The last pinned block referenced by each column in the current chunk
+	vector<idx_t> column_blocks;
 	// Range to read
 	XLSXCellRange range;
 	// Mapping from chunk row to sheet row
 	unsafe_unique_array<idx_t> sheet_row_number;
 	// Current chunk
 	DataChunk chunk;
+	Allocator &allocator;
+	// Columns without any data in the current chunk reference this constant NULL vector
+	Vector null_vector;
+	// Lazily created vector caches, for the columns that have received data at some point
+	vector<unique_ptr<VectorCache>> column_caches;
+	// The columns that have received data in the current chunk
+	vector<bool> column_active;
+	vector<idx_t> active_columns;
+	// The columns we track the number cells of, and the number cells of each in the current chunk
+	vector<bool> track_numbers;
+	vector<ValidityMask> number_cells;
 	// Current row in the chunk
 	idx_t out_index = 0;
 
-	// The last column we wrote to
-	idx_t last_col;
 	// The last row we wrote to
 	idx_t last_row;
 	idx_t curr_row;
@@ -428,27 +538,90 @@ inline string SheetParser::GetCellName(idx_t chunk_row, idx_t chunk_col) const {
 	return pos.ToString();
 }
 
+inline void SheetParser::ResetChunk() {
+	chunk.SetCardinality(0);
+	// Every column starts out as a constant NULL, and is only allocated once we write to it.
+	// This way empty rows and columns dont need to be padded cell by cell.
+	for (const auto col_idx : active_columns) {
+		chunk.data[col_idx].Reference(null_vector);
+		column_active[col_idx] = false;
+	}
+	active_columns.clear();
+	pinned_blocks.clear();
+	std::fill(column_blocks.begin(), column_blocks.end(), DConstants::INVALID_INDEX);
+}
+
+inline string_t SheetParser::GetSharedString(Vector &vec, const idx_t col_idx, const char *ssi_str) {
+	const auto ssi = static_cast<idx_t>(std::strtoull(ssi_str, nullptr, 10));
+	if (ssi >= string_table.Count()) {
+		throw InvalidInputException("XLSX: Shared string index '%d' out of range (is the file corrupted?)", ssi);
+	}
+	if (!string_table.IsSpillable()) {
+		return string_table.Get(ssi);
+	}
+
+	// The string table might be spilled to disk, so we need to pin the block containing the string
+	const auto block = string_table.GetBlock(ssi);
+	auto entry = pinned_blocks.find(block);
+	if (entry == pinned_blocks.end()) {
+		auto pin = make_buffer<StringTablePin>(string_table.Pin(block));
+		entry = pinned_blocks.emplace(block, std::move(pin)).first;
+	}
+
+	const auto result = string_table.Get(ssi, entry->second->handle);
+
+	// Unless the string is inlined, the vector has to keep the block pinned for as long as it references it
+	if (!result.IsInlined() && column_blocks[col_idx] != block) {
+		StringVector::AddBuffer(vec, entry->second);
+		column_blocks[col_idx] = block;
+	}
+	return result;
+}
+
+inline Vector &SheetParser::GetColumn(const idx_t col_idx) {
+	auto &vec = chunk.data[col_idx];
+	if (column_active[col_idx]) {
+		return vec;
+	}
+
+	auto &cache = column_caches[col_idx];
+	if (!cache) {
+		cache = make_uniq<VectorCache>(allocator, LogicalType::VARCHAR);
+	}
+	vec.ResetFromCache(*cache);
+
+	// All the rows up until now (and any we skip over later) are NULL
+	FlatVector::Validity(vec).SetAllInvalid(STANDARD_VECTOR_SIZE);
+	if (track_numbers[col_idx]) {
+		number_cells[col_idx].SetAllInvalid(STANDARD_VECTOR_SIZE);
+	}
+
+	column_active[col_idx] = true;
+	active_columns.push_back(col_idx);
+	return vec;
+}
+
+inline void SheetParser::TrackNumberCells(const idx_t col_idx) {
+	track_numbers[col_idx] = true;
+	number_cells[col_idx].Initialize(STANDARD_VECTOR_SIZE);
+}
+
 inline bool SheetParser::FoundSkippedRow() const {
 	return last_row + 1 < curr_row;
 }
 
 inline void SheetParser::SkipRows() {
-	// Pad empty rows
-	while (last_row + 1 < curr_row) {
-		last_row++;
+	// Pad empty rows. All rows start out as NULL, so we just have to move past them.
+	// If the whole chunk ends up empty, all columns are emitted as constant NULL vectors.
+	const auto remaining = MinValue<idx_t>(curr_row - last_row - 1, STANDARD_VECTOR_SIZE - out_index);
+	for (idx_t i = 0; i < remaining; i++) {
+		sheet_row_number[out_index++] = ++last_row;
+	}
+	chunk.SetCardinality(out_index);
 
-		for (auto &col : chunk.data) {
-			FlatVector::SetNull(col, out_index, true);
-		}
-		sheet_row_number[out_index] = last_row;
-		out_index++;
-		chunk.SetCardinality(out_index);
-
-		if (out_index == STANDARD_VECTOR_SIZE) {
-			// We have filled up the chunk, yield!
-			out_index = 0;
-			return;
-		}
+	if (out_index == STANDARD_VECTOR_SIZE) {
+		// We have filled up the chunk, yield!
+		out_index = 0;
 	}
 }
 
@@ -457,15 +630,11 @@ inline void SheetParser::FillRows() {
 	const auto local_remaining = STANDARD_VECTOR_SIZE - out_index;
 
 	const auto remaining = MinValue(total_remaining, local_remaining);
+	// All rows start out as NULL, so we just have to move past them
 	for (idx_t i = 0; i < remaining; i++) {
-		for (auto &col : chunk.data) {
-			FlatVector::SetNull(col, out_index, true);
-		}
-		sheet_row_number[out_index] = last_row;
-		out_index++;
-		last_row++;
+		sheet_row_number[out_index++] = ++last_row;
 	}
-	chunk.SetCardinality(chunk.size() + remaining);
+	chunk.SetCardinality(out_index);
 	out_index = 0;
 }
 
@@ -475,7 +644,6 @@ inline void SheetParser::OnBeginRow(idx_t row_idx) {
 		return;
 	}
 
-	last_col = range.beg.col - 1;
 	is_row_empty = true;
 
 	curr_row = row_idx;
@@ -492,41 +660,36 @@ inline void SheetParser::OnCell(const XLSXCellPos &pos, XLSXCellType type, vecto
 		return;
 	}
 
-	// If we jumped over some columns, pad with nulls
-	if (last_col + 1 < pos.col) {
-		for (idx_t i = last_col + 1; i < pos.col; i++) {
-			auto &vec = chunk.data[i - range.beg.col];
-			FlatVector::SetNull(vec, out_index, true);
-		}
+	// Get the column data. Columns we skip over are already NULL, so we dont need to pad them.
+	const auto col_idx = pos.col - range.beg.col;
+	if (data.empty() && type != XLSXCellType::INLINE_STRING && type != XLSXCellType::SHARED_STRING) {
+		// If the cell is empty (and not a string), we wont be able to convert it
+		// so just leave it as NULL
+		return;
 	}
-
-	// Get the column data
-	auto &vec = chunk.data[pos.col - range.beg.col];
+	auto &vec = GetColumn(col_idx);
 
 	// Push the cell data to our chunk
 	const auto ptr = FlatVector::GetData<string_t>(vec);
+	if (track_numbers[col_idx] && type == XLSXCellType::NUMBER) {
+		number_cells[col_idx].SetValid(out_index);
+	}
 
 	if (type == XLSXCellType::SHARED_STRING) {
 		// Push a null to the buffer so that the string is null-terminated
 		data.push_back('\0');
-		// Now we can use strtol to get the shared string index
-		const auto ssi = std::strtol(data.data(), nullptr, 10);
 		// Look up the string in the string table
-		ptr[out_index] = string_table.Get(ssi);
-	} else if (data.empty() && type != XLSXCellType::INLINE_STRING) {
-		// If the cell is empty (and not a string), we wont be able to convert it
-		// so just null it immediately
-		FlatVector::SetNull(vec, out_index, true);
+		ptr[out_index] = GetSharedString(vec, col_idx, data.data());
+		FlatVector::Validity(vec).SetValid(out_index);
 	} else {
 		// Otherwise just pass along the call data, we will cast it later.
 		ptr[out_index] = StringVector::AddString(vec, data.data(), data.size());
+		FlatVector::Validity(vec).SetValid(out_index);
 	}
 
 	if (!data.empty()) {
 		is_row_empty = false;
 	}
-
-	last_col = pos.col;
 }
 
 inline void SheetParser::OnEndRow(idx_t row_idx) {
@@ -542,15 +705,7 @@ inline void SheetParser::OnEndRow(idx_t row_idx) {
 		return;
 	}
 
-	// If we didnt write out all the columns, pad with nulls
-	if (last_col + 1 < range.end.col) {
-		for (idx_t i = last_col + 1; i < range.end.col; i++) {
-			auto &vec = chunk.data[i - range.beg.col];
-			FlatVector::SetNull(vec, out_index, true);
-		}
-	}
-
-	// Map the chunk row to the sheet row
+	// Map the chunk row to the sheet row. Any columns we didnt write to are already NULL.
 	sheet_row_number[out_index] = UnsafeNumericCast<int32_t>(row_idx);
 
 	out_index++;
@@ -562,4 +717,4 @@ inline void SheetParser::OnEndRow(idx_t row_idx) {
 	}
 }
 
-} // namespace duckdb
\ No newline at end of file
+} // namespace duckdb
@@ -7,16 +7,28 @@
 namespace duckdb {
 
 class DatabaseInstance;
+class ZipStreamBuffer;
 
 struct WriteXLSX {
 	static void Register(DatabaseInstance &db);
 };
 
+struct GenerateXLSX {
+	static void Register(DatabaseInstance &db);
+};
+
+struct XLSXMetadata {
+	static void Register(DatabaseInstance &db);
+};
+
 enum class XLSXHeaderMode : uint8_t { NEVER, MAYBE, FORCE };
 
 class XLSXReadOptions {
 public:
 	string sheet;
+	// Read the range of an excel table or a defined name instead of a sheet
+	string table_name;
+	string defined_name;
 	XLSXHeaderMode header_mode = XLSXHeaderMode::MAYBE;
 	bool all_varchar = false;
 	bool ignore_errors = false;
@@ -24,12 +36,20 @@ public:
 	bool has_explicit_range = false;
 	XLSXCellType default_cell_type = XLSXCellType::NUMBER;
 	XLSXCellRange range;
+	// Explicit column types, and optionally names, that replace the sniffed ones
+	vector<LogicalType> column_types;
+	vector<string> column_names;
 };
 
 class XLSXReadData final : public TableFunctionData {
 public:
 	string file_path;
 	string sheet_path;
+	// The contents of the file when reading from a BLOB, in which case the file path is not used
+	shared_ptr<const string> file_data;
+	// The parts of the file needed to read it when it can't be read randomly (e.g. a pipe), in which case the file
+	// path is not used either
+	shared_ptr<const ZipStreamBuffer> stream_data;
 
 	vector<LogicalType> return_types;
 	vector<XLSXCellType> source_types;
@@ -40,11 +60,84 @@ public:
 };
 
 class ZipFileReader;
+class SheetParserBase;
+class SheetParser;
+class StringTable;
+class TemporaryMemoryState;
+struct XLSXRelation;
+
+// Convert an excel serial number (days since 1900-01-01) to microseconds since the unix epoch
+int64_t ExcelToEpochUS(double serial);
+
+// The parts of a workbook that are stored differently in xlsx (XML) and xlsb (BIFF12) files
+struct XLSXWorkbookFormat {
+	// The kind of file, used in error messages
+	const char *name;
+	// The entries holding the workbook and its relations
+	const char *workbook_path;
+	const char *workbook_rels_path;
+	// The entry holding the shared string table
+	const char *shared_strings_path;
+	// Get the (name, relation id) pairs of the sheets in the currently open workbook entry
+	vector<pair<string, string>> (*get_sheets)(ZipFileReader &archive);
+	// Feed the cells of the currently open sheet entry to the parser
+	void (*read_sheet)(ZipFileReader &archive, SheetParserBase &parser);
+	// Look up the strings with the given ids in the currently open shared strings entry
+	unordered_map<idx_t, string> (*search_strings)(ZipFileReader &archive, const vector<idx_t> &ids);
+};
 
 struct ReadXLSX {
+	static const XLSXWorkbookFormat XLSX_FORMAT;
+
+
+	// Set the file path, or the file data if the input is a BLOB or a file that can't be read randomly (e.g. a pipe).
+	// The options need to be parsed already, so that only the sheet they select is kept from a stream
+	static void BindInput(ClientContext &context, XLSXReadData &result, const Value &input,
+	                      const string &function_name, const XLSXWorkbookFormat &format);
+	// Open the archive of the file path or file data
+	static ZipFileReader OpenArchive(ClientContext &context, const XLSXReadData &data);
 	// options and file path need to be resolved already
 	static void ParseOptions(XLSXReadOptions &options, const named_parameter_map_t &input);
 	static void ResolveSheet(const unique_ptr<XLSXReadData> &result, ZipFileReader &archive);
+	// Parse the "xl/styles.xml" entry, if any, into the style sheet of the result
+	static void ParseStyleSheet(XLSXReadData &result, ZipFileReader &archive);
+
+	// The parts below are shared with the xlsb reader, which only differs in how the workbook is stored
+
+	// Sniff the range of the data in the sheet
+	static void SniffRange(XLSXReadData &result, ZipFileReader &archive, const XLSXWorkbookFormat &format);
+	// Sniff the header and column types of the sheet within the range of the options, and bind the columns
+	static void SniffHeader(XLSXReadData &result, ZipFileReader &archive, const XLSXWorkbookFormat &format);
+
+	// Map the (name, relation id) pairs of the workbook to (name, entry path) pairs of the worksheets, in order
+	static vector<pair<string, string>> GetSheetPaths(const vector<pair<string, string>> &sheets,
+	                                                  const vector<XLSXRelation> &wbrels);
+	// Resolve the sheet to read from the (name, relation id) pairs of the workbook and its relations
+	static void SelectSheet(const unique_ptr<XLSXReadData> &result, const vector<pair<string, string>> &sheets,
+	                        const vector<XLSXRelation> &wbrels);
+	// Make up header and data cells if the sniffed range has no data rows
+	static void PadHeader(const XLSXReadOptions &options, vector<XLSXCell> &header_cells,
+	                      vector<XLSXCell> &column_cells);
+	// Set the column names and types, shared strings in the header must already be resolved
+	static void BindColumns(XLSXReadData &result, const vector<XLSXCell> &header_cells,
+	                        vector<XLSXCell> &column_cells);
+	// Whether numbers read as this type are converted from excel serials (days since 1900)
+	static bool IsExcelSerialType(const LogicalType &type);
+	// Set up the sheet parser to track the cells holding numbers in the columns converted from excel serials
+	static void InitParser(const XLSXReadData &bind_data, SheetParser &parser);
+	// Cast the VARCHAR chunk produced by the sheet parser into the output types.
+	// Returns the number of cells that failed to cast and were set to NULL because errors are ignored
+	static idx_t CastChunk(ClientContext &context, const XLSXReadData &bind_data, SheetParser &parser,
+	                       Vector &cast_vec, DataChunk &output);
+	// Reserve memory for a shared string table of the estimated size, and for parse_size bytes more that are only
+	// needed while parsing it. If we can't reserve enough for the table itself, the table is made spillable so the
+	// buffer manager can evict it to disk while we scan. Returns whether the parse memory was reserved as well
+	static bool ReserveStringTable(ClientContext &context, StringTable &strings,
+	                               unique_ptr<TemporaryMemoryState> &memory, idx_t estimated_size,
+	                               idx_t parse_size = 0);
+	// Shrink the reservation to what the parsed string table actually needs
+	static void ShrinkStringTableReservation(ClientContext &context, const StringTable &strings,
+	                                         TemporaryMemoryState &memory);
 
 	static void Register(DatabaseInstance &db);
 	static TableFunction GetFunction();
@@ -1,32 +1,94 @@
 #pragma once
 
-#include "duckdb/common/allocator.hpp"
 #include "duckdb/common/string_map_set.hpp"
 #include "duckdb/common/types/string_type.hpp"
+#include "duckdb/common/types/vector_buffer.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
 
 namespace duckdb {
 
 //-------------------------------------------------------------------
 // String Table
 //-------------------------------------------------------------------
-// StringTable is a simple class that stores a unique set of strings
-// in arena backed memory and allows fast access by index.
+// StringTable stores strings back-to-back in buffer managed blocks,
+// addressed by a (block, offset) entry per string, and allows fast
+// access by index. Strings never span blocks.
+//
+// Strings can either be appended as-is (Append), which is what we do
+// for the shared string table of a workbook as it is already unique and
+// only ever looked up by index, or deduplicated (Add), in which case we
+// additionally maintain a hash map from string to index.
+//
+// By default all blocks stay pinned so that lookups can hand out
+// pointers directly. If the table is made spillable, only the block we
+// are currently appending to stays pinned, and the buffer manager is
+// free to evict the others to disk. Lookups then have to pin the block
+// containing the string first (see GetBlock/Pin).
 
 class StringTable {
 public:
-	explicit StringTable(Allocator &alloc) : arena(alloc) {
+	explicit StringTable(BufferManager &buffer_manager_p) : buffer_manager(buffer_manager_p) {
 	}
+	// Add a string to the table, returning the index of an equal string if it already exists
 	idx_t Add(const string_t &str);
-	const string_t &Get(idx_t val) const;
+	// Find a string added through Add, returns DConstants::INVALID_INDEX if there is no equal string
+	idx_t Find(const string_t &str) const;
+	// Append a string to the end of the table without checking for duplicates
+	idx_t Append(const char *str, idx_t len);
+	// Move all strings of another table to the end of this table without checking for duplicates
+	void Append(StringTable &other);
+	// Lookup a string, only valid if the table is not spillable
+	string_t Get(idx_t val) const;
+	// Lookup a string in a block that has been pinned by the caller
+	string_t Get(idx_t val, const BufferHandle &pin) const;
+	idx_t GetBlock(idx_t val) const {
+		return entries[val].block;
+	}
+	BufferHandle Pin(idx_t block) const;
+
 	void Reserve(idx_t count);
+	void SetSpillable(bool spillable);
+	bool IsSpillable() const {
+		return spillable;
+	}
+	idx_t Count() const {
+		return entries.size();
+	}
+	// Returns the amount of memory allocated for the string data
+	idx_t GetSizeInBytes() const {
+		return size_in_bytes;
+	}
+
+private:
+	idx_t GetLength(idx_t val) const;
+	void AllocateBlock(idx_t min_capacity);
 
 private:
-	ArenaAllocator arena;
+	struct Entry {
+		uint32_t block;
+		uint32_t offset;
+	};
+	struct Block {
+		shared_ptr<BlockHandle> handle;
+		BufferHandle pin;
+		idx_t size;
+		idx_t capacity;
+	};
+
+	static constexpr idx_t BLOCK_CAPACITY = 256ULL * 1024ULL;
+
+	BufferManager &buffer_manager;
+	vector<Block> blocks;
+	vector<Entry> entries;
+	// Only populated when strings are added through Add
 	string_map_t<idx_t> table;
-	vector<string_t> index; // todo: make this a reference to the key in the map?
+	bool spillable = false;
+	idx_t size_in_bytes = 0;
 };
 
 inline idx_t StringTable::Add(const string_t &str) {
+	// We can only hand out stable keys for the map if the blocks stay pinned
+	D_ASSERT(!spillable);
 
 	// Check if the string is already in the map
 	const auto found = table.find(str);
@@ -34,36 +96,141 @@ inline idx_t StringTable::Add(const string_t &str) {
 		return found->second;
 	}
 
-	// Create a new entry
-	const auto val = index.size();
+	// Create a new entry, and key the map on the copy stored in the table
+	const auto val = Append(str.GetData(), str.GetSize());
+	table[Get(val)] = val;
+	return val;
+}
 
-	// If the string is inlined, just store it in the map and vector
-	if (str.IsInlined()) {
-		table[str] = val;
-		index.push_back(str);
-		return val;
-	}
+inline idx_t StringTable::Find(const string_t &str) const {
+	const auto found = table.find(str);
+	return found == table.end() ? DConstants::INVALID_INDEX : found->second;
+}
 
-	// Otherwise copy the string to the arena
-	const auto len = str.GetSize();
-	const auto src = str.GetData();
-	const auto dst = arena.Allocate(len);
-	memcpy(dst, src, len);
+inline idx_t StringTable::Append(const char *str, const idx_t len) {
+	if (blocks.empty() || blocks.back().size + len > blocks.back().capacity) {
+		AllocateBlock(len);
+	}
 
-	const auto key = string_t(const_char_ptr_cast(dst), len);
-	table[key] = val;
-	index.push_back(key);
+	auto &block = blocks.back();
+	memcpy(block.pin.Ptr() + block.size, str, len);
 
+	const auto val = Count();
+	entries.push_back({UnsafeNumericCast<uint32_t>(blocks.size() - 1), UnsafeNumericCast<uint32_t>(block.size)});
+	block.size += len;
 	return val;
 }
 
-inline const string_t &StringTable::Get(const idx_t val) const {
-	return index[val];
+inline void StringTable::Append(StringTable &other) {
+	// Only supported when not deduplicating, we would have to merge the maps otherwise
+	D_ASSERT(table.empty());
+	if (other.blocks.empty()) {
+		return;
+	}
+
+	// We wont append to our current block anymore, so it can be unpinned
+	if (spillable && !blocks.empty()) {
+		blocks.back().pin.Destroy();
+	}
+
+	// Rebase the entries of the other table onto the end of this one
+	const auto block_offset = UnsafeNumericCast<uint32_t>(blocks.size());
+	entries.reserve(entries.size() + other.entries.size());
+	for (const auto &entry : other.entries) {
+		entries.push_back({entry.block + block_offset, entry.offset});
+	}
+	for (auto &block : other.blocks) {
+		if (!spillable && !block.pin.IsValid()) {
+			block.pin = buffer_manager.Pin(block.handle);
+		}
+		blocks.push_back(std::move(block));
+	}
+	size_in_bytes += other.size_in_bytes;
+
+	other.blocks.clear();
+	other.entries.clear();
+	other.size_in_bytes = 0;
+}
+
+inline idx_t StringTable::GetLength(const idx_t val) const {
+	const auto &entry = entries[val];
+	if (val + 1 < entries.size() && entries[val + 1].block == entry.block) {
+		return entries[val + 1].offset - entry.offset;
+	}
+	// This is the last string in the block
+	return blocks[entry.block].size - entry.offset;
+}
+
+inline string_t StringTable::Get(const idx_t val) const {
+	D_ASSERT(val < Count());
+	D_ASSERT(blocks[entries[val].block].pin.IsValid());
+	return Get(val, blocks[entries[val].block].pin);
+}
+
+inline string_t StringTable::Get(const idx_t val, const BufferHandle &pin) const {
+	D_ASSERT(val < Count());
+	const auto ptr = pin.Ptr() + entries[val].offset;
+	return string_t(const_char_ptr_cast(ptr), UnsafeNumericCast<uint32_t>(GetLength(val)));
+}
+
+inline BufferHandle StringTable::Pin(const idx_t block) const {
+	auto handle = blocks[block].handle;
+	return buffer_manager.Pin(handle);
 }
 
 inline void StringTable::Reserve(const idx_t count) {
-	table.reserve(count);
-	index.reserve(count);
+	entries.reserve(count);
+	if (!table.empty()) {
+		table.reserve(count);
+	}
+}
+
+inline void StringTable::SetSpillable(const bool spillable_p) {
+	D_ASSERT(table.empty());
+	spillable = spillable_p;
+	for (idx_t i = 0; i < blocks.size(); i++) {
+		auto &block = blocks[i];
+		const auto is_last = i + 1 == blocks.size();
+		if (spillable && !is_last) {
+			block.pin.Destroy();
+		} else if (!block.pin.IsValid()) {
+			block.pin = buffer_manager.Pin(block.handle);
+		}
+	}
+}
+
+inline void StringTable::AllocateBlock(const idx_t min_capacity) {
+	// We're done appending to the current block, so it can be unpinned (and spilled) if needed
+	if (spillable && !blocks.empty()) {
+		blocks.back().pin.Destroy();
+	}
+
+	// Strings larger than a block get a block of their own
+	const auto capacity = MaxValue(BLOCK_CAPACITY, min_capacity);
+
+	Block block;
+	block.pin = buffer_manager.Allocate(MemoryTag::EXTENSION, capacity, false);
+	block.handle = block.pin.GetBlockHandle();
+	block.size = 0;
+	block.capacity = capacity;
+	blocks.push_back(std::move(block));
+
+	size_in_bytes += capacity;
 }
 
-} // namespace duckdb
\ No newline at end of file
+//-------------------------------------------------------------------
+// String Table Pin
+//-------------------------------------------------------------------
+// Keeps a block of a spillable string table pinned for as long as a
+// vector that references strings in it is alive.
+
+class StringTablePin final : public VectorBuffer {
+public:
+	explicit StringTablePin(BufferHandle handle_p)
+	    : VectorBuffer(VectorBufferType::OPAQUE_BUFFER), handle(std::move(handle_p)) {
+	}
+
+	BufferHandle handle;
+};
+
+} // namespace duckdb
@@ -14,6 +14,8 @@ namespace duckdb {
 constexpr auto XLSX_MAX_CELL_SIZE = 32767UL;
 constexpr auto XLSX_MAX_CELL_ROWS = 1048576UL;
 constexpr auto XLSX_MAX_CELL_COLS = 16384UL;
+// In UTF-16 code units
+constexpr auto XLSX_MAX_SHEET_NAME_LENGTH = 31UL;
 
 //-------------------------------------------------------------------------
 // Cell position
@@ -2,21 +2,272 @@
 
 #include "xlsx/zip_file.hpp"
 #include "xlsx/xml_util.hpp"
+#include "xlsx/string_table.hpp"
+
+#include "duckdb/storage/buffer_manager.hpp"
+#include "duckdb/storage/temporary_memory_manager.hpp"
+
+#include <deque>
 
 namespace duckdb {
 
+//-------------------------------------------------------------------
+// Row Buffer
+//-------------------------------------------------------------------
+// Rows serialized to XML, with the row numbers left out. These are
+// filled in when the rows are appended to a sheet, so that batches of
+// rows can be serialized in parallel before their position in the
+// sheet is known.
+//
+// The same goes for shared strings, which are deduplicated within the
+// buffer and only added to the shared string table of the workbook
+// (or written inline, if the table has grown too large) on append.
+//-------------------------------------------------------------------
+class XLSXRowBuffer {
+public:
+	explicit XLSXRowBuffer(idx_t column_count);
+
+	void BeginRow();
+	void EndRow();
+
+	void WriteNumberCell(const string_t &value);
+	void WriteInlineStringCell(const string_t &value);
+	// Write a string cell that references the shared string table. Returns true if the string is new to this buffer
+	bool WriteSharedStringCell(const string_t &value);
+	void WriteBooleanCell(const string_t &value);
+	void WriteDateCell(const string_t &value);
+	void WriteTimeCell(const string_t &value);
+	void WriteTimestampCell(const string_t &value);
+	void WriteTimestampCellNoMilliseconds(const string_t &value);
+	void WriteEmptyCell();
+
+	idx_t GetRowCount() const {
+		return row_ends.size();
+	}
+	idx_t GetSizeInBytes() const {
+		return data.size();
+	}
+	void Reserve(idx_t size_in_bytes) {
+		data.reserve(size_in_bytes);
+	}
+	// Clear the rows, but keep the memory allocated for them
+	void Clear();
+
+private:
+	friend class XLXSWriter;
+
+	template <idx_t N>
+	void Append(const char (&str)[N]) {
+		data.append(str, N - 1);
+	}
+	// Write the reference of the next cell, up to the row number
+	void BeginCell();
+	void WriteRowNumber();
+	// Write a cell with a value, the attributes start with the closing quote of the cell reference
+	template <idx_t N>
+	void WriteValueCell(const char (&attributes)[N], const string_t &value);
+
+	// The start of the cells of every column, e.g. <c r="AB
+	vector<string> cell_prefixes;
+	idx_t col_idx = 0;
+
+	// A gap in the data that is filled in when the rows are appended, either with the row number, or with the
+	// type attribute and value of a shared string cell
+	struct Gap {
+		idx_t offset;
+		idx_t string_idx;
+	};
+
+	string data;
+	vector<Gap> gaps;
+	// The end of each row, as an index into the gaps
+	vector<idx_t> row_ends;
+
+	// The distinct shared strings of the buffer. Stored in a deque so that the map keys stay valid
+	std::deque<string> strings;
+	string_map_t<idx_t> string_map;
+
+	vector<char> escaped_buffer;
+};
+
+inline XLSXRowBuffer::XLSXRowBuffer(const idx_t column_count) {
+	cell_prefixes.resize(column_count);
+	for (idx_t i = 0; i < column_count; i++) {
+		cell_prefixes[i] = "<c r=\"" + XLSXCellPos(1, i + 1).GetColumnName();
+	}
+}
+
+inline void XLSXRowBuffer::WriteRowNumber() {
+	gaps.push_back({data.size(), DConstants::INVALID_INDEX});
+}
+
+inline void XLSXRowBuffer::BeginRow() {
+	Append("<row r=\"");
+	WriteRowNumber();
+	Append("\">");
+}
+
+inline void XLSXRowBuffer::EndRow() {
+	Append("</row>");
+	row_ends.push_back(gaps.size());
+	col_idx = 0;
+}
+
+inline void XLSXRowBuffer::BeginCell() {
+	data += cell_prefixes[col_idx];
+	WriteRowNumber();
+	col_idx++;
+}
+
+template <idx_t N>
+void XLSXRowBuffer::WriteValueCell(const char (&attributes)[N], const string_t &value) {
+	BeginCell();
+	Append(attributes);
+	data.append(value.GetData(), value.GetSize());
+	Append("</v></c>");
+}
+
+inline void XLSXRowBuffer::WriteNumberCell(const string_t &value) {
+	WriteValueCell("\" t=\"n\"><v>", value);
+}
+
+inline void XLSXRowBuffer::WriteBooleanCell(const string_t &value) {
+	WriteValueCell("\" t=\"b\" s=\"5\"><v>", value);
+}
+
+inline void XLSXRowBuffer::WriteDateCell(const string_t &value) {
+	WriteValueCell("\" t=\"n\" s=\"1\"><v>", value);
+}
+
+inline void XLSXRowBuffer::WriteTimeCell(const string_t &value) {
+	WriteValueCell("\" t=\"n\" s=\"3\"><v>", value);
+}
+
+inline void XLSXRowBuffer::WriteTimestampCell(const string_t &value) {
+	WriteValueCell("\" t=\"n\" s=\"4\"><v>", value);
+}
+
+inline void XLSXRowBuffer::WriteTimestampCellNoMilliseconds(const string_t &value) {
+	WriteValueCell("\" t=\"n\" s=\"2\"><v>", value);
+}
+
+inline void XLSXRowBuffer::WriteInlineStringCell(const string_t &value) {
+	BeginCell();
+	Append("\" t=\"inlineStr\"><is><t>");
+	// We need to escape this string in case it contains XML special characters
+	EscapeXMLString(value.GetData(), value.GetSize(), escaped_buffer);
+	data.append(escaped_buffer.data(), escaped_buffer.size());
+	Append("</t></is></c>");
+}
+
+inline bool XLSXRowBuffer::WriteSharedStringCell(const string_t &value) {
+	idx_t string_idx;
+	const auto entry = string_map.find(value);
+	const auto is_new = entry == string_map.end();
+	if (is_new) {
+		string_idx = strings.size();
+		strings.emplace_back(value.GetData(), value.GetSize());
+		string_map.emplace(string_t(strings.back()), string_idx);
+	} else {
+		string_idx = entry->second;
+	}
+
+	BeginCell();
+	Append("\" ");
+	gaps.push_back({data.size(), string_idx});
+	Append("</c>");
+	return is_new;
+}
+
+inline void XLSXRowBuffer::WriteEmptyCell() {
+	col_idx++;
+}
+
+inline void XLSXRowBuffer::Clear() {
+	data.clear();
+	gaps.clear();
+	row_ends.clear();
+	string_map.clear();
+	strings.clear();
+	col_idx = 0;
+}
+
+//-------------------------------------------------------------------
+// Row Number
+//-------------------------------------------------------------------
+// The decimal digits of the current row number, which are incremented
+// in place rather than formatting the number again for every row.
+//-------------------------------------------------------------------
+class XLSXRowNumber {
+public:
+	void Increment() {
+		for (idx_t i = MAX_DIGITS; i-- > start;) {
+			if (digits[i] != '9') {
+				digits[i]++;
+				return;
+			}
+			digits[i] = '0';
+		}
+		// All digits were nines (or there are none yet), so we need another digit
+		digits[--start] = '1';
+	}
+	void Reset() {
+		start = MAX_DIGITS;
+	}
+	const char *GetData() const {
+		return digits + start;
+	}
+	idx_t GetSize() const {
+		return MAX_DIGITS - start;
+	}
+
+private:
+	static constexpr idx_t MAX_DIGITS = 20;
+	char digits[MAX_DIGITS];
+	idx_t start = MAX_DIGITS;
+};
+
+//-------------------------------------------------------------------
+// Writer
+//-------------------------------------------------------------------
 class XLXSWriter {
 public:
 	void BeginSheet(const string &sheet_name, const vector<string> &sql_column_names,
 	                const vector<LogicalType> &sql_column_types);
 	void EndSheet();
 
-	explicit XLXSWriter(ClientContext &context, const string &file_name, idx_t sheet_row_limit_p)
-	    : stream(context, file_name), sheet_row_limit(sheet_row_limit_p) {
+	explicit XLXSWriter(ClientContext &context, const string &file_name, idx_t sheet_row_limit_p,
+	                    idx_t write_buffer_size = ZipFileWriter::DEFAULT_WRITE_BUFFER_SIZE)
+	    : stream(context, file_name, write_buffer_size), sheet_row_limit(sheet_row_limit_p), rows(0),
+	      shared_strings(BufferManager::GetBufferManager(context)) {
+		output.reserve(OUTPUT_BUFFER_SIZE + ROW_BUFFER_FLUSH_SIZE);
+
+		// The shared string table stays pinned until the workbook is finished, so only let it grow as large as the
+		// memory we can reserve for it. Other writers and operators may need memory too
+		auto &memory_manager = TemporaryMemoryManager::Get(context);
+		shared_strings_memory = memory_manager.Register(context);
+		shared_strings_memory->SetRemainingSizeAndUpdateReservation(context, SHARED_STRINGS_MEMORY_LIMIT);
+		shared_strings_limit = MinValue(shared_strings_memory->GetReservation(), SHARED_STRINGS_MEMORY_LIMIT);
+	}
+
+	// Set the deflate level of the parts of the workbook, 0 stores them uncompressed. Must be set before the first sheet
+	void SetCompressionLevel(int16_t level) {
+		stream.SetCompressionLevel(level);
+	}
+
+	// Continue in a new sheet once the active sheet reaches the row limit, instead of throwing. The new sheets are
+	// named after the active sheet with a numbered suffix (Sheet1, Sheet1 (2), Sheet1 (3), ...) and start with a
+	// header row with the column names if repeat_header is set.
+	void EnableSheetRollover(bool repeat_header) {
+		sheet_rollover = true;
+		repeat_header_row = repeat_header;
 	}
 
+	// Write single cells to the active sheet, these are buffered and appended to the sheet in bulk
 	void WriteNumberCell(const string_t &value);
 	void WriteInlineStringCell(const string_t &value);
+	// Write a string cell referencing the shared string table, adding the string to the table if needed
+	void WriteSharedStringCell(const string_t &value);
 	void WriteBooleanCell(const string_t &value);
 	void WriteDateCell(const string_t &value);
 	void WriteTimeCell(const string_t &value);
@@ -26,13 +277,31 @@ public:
 	void BeginRow();
 	void EndRow();
 
-	void Finish();
+	// Append rows serialized elsewhere to the active sheet, numbering them after the rows written so far
+	void AppendRows(const XLSXRowBuffer &buffer);
+	// Help compressing the active sheet, this is safe to call from other threads while rows are appended
+	void CompressBlocks() {
+		stream.CompressBlocks();
+	}
+
+	// Write the remaining parts of the workbook and close the file, syncing it to disk only if requested
+	void Finish(bool sync = false);
 
 private:
 	idx_t WriteEscapedXML(const char *str);
 	idx_t WriteEscapedXML(const string &str);
 	idx_t WriteEscapedXML(const char *buffer, idx_t write_size);
 
+	void FlushRows();
+	void WriteRows(const XLSXRowBuffer &buffer);
+
+	void OpenSheetFile();
+	void CloseSheetFile();
+	// End the active sheet and continue in the next one, with the same columns
+	void RollOverSheet();
+	// The escaped name of the next sheet rolled over to, which is unique within the workbook
+	string GetRolloverSheetName();
+
 	void WriteStyles();
 	void WriteWorkbook();
 	void WriteRels();
@@ -44,7 +313,6 @@ private:
 	public:
 		string sheet_name;
 		string sheet_file;
-		vector<string> sheet_column_names; // A1... Z1, AA1... ZZ1, etc.
 		vector<string> sheet_column_types; // e.g. "str", "n", etc.
 		vector<string> sql_column_names;
 		vector<LogicalType> sql_column_types;
@@ -52,17 +320,40 @@ private:
 
 	ZipFileWriter stream;
 	idx_t sheet_row_limit = XLSX_MAX_CELL_ROWS;
+	bool sheet_rollover = false;
+	bool repeat_header_row = false;
+	// The unescaped name of the first sheet the rows rolled over from, and the number of the last sheet rolled over to
+	string rollover_base_name;
+	idx_t rollover_sheet_number = 1;
 
 	// Current sheet data;
-	string row_str = "1";
 	idx_t row_idx = 0;
-	idx_t col_idx = 0;
 	bool has_active_sheet = false;
 
 	XLSXSheet active_sheet;
 	vector<XLSXSheet> written_sheets;
 
+	// Rows written cell by cell, that have not been appended to the sheet yet
+	XLSXRowBuffer rows;
+	static constexpr idx_t ROW_BUFFER_FLUSH_SIZE = 1024 * 1024;
+
 	vector<char> escaped_buffer;
+
+	// Shared strings, and the total number of cells referencing them
+	StringTable shared_strings;
+	idx_t shared_string_refs = 0;
+	// New strings are written inline once the shared string table has grown this large
+	static constexpr idx_t SHARED_STRINGS_MEMORY_LIMIT = 64ULL * 1024ULL * 1024ULL;
+	// The memory reserved for the shared string table, and the size it may grow to within that reservation
+	unique_ptr<TemporaryMemoryState> shared_strings_memory;
+	idx_t shared_strings_limit = 0;
+	// The shared string index of the strings of the buffer being appended
+	vector<idx_t> resolved_strings;
+
+	// The rows being appended, with their gaps filled in
+	XLSXRowNumber row_number;
+	string output;
+	static constexpr idx_t OUTPUT_BUFFER_SIZE = 1024 * 1024;
 };
 
 inline void XLXSWriter::BeginSheet(const string &sheet_name, const vector<string> &sql_column_names,
@@ -77,25 +368,14 @@ inline void XLXSWriter::BeginSheet(const string &sheet_name, const vector<string
 	D_ASSERT(!has_active_sheet);
 	has_active_sheet = true;
 	active_sheet.sheet_name = EscapeXMLString(sheet_name);
-	active_sheet.sheet_file = "sheet" + std::to_string(written_sheets.size() + 1) + ".xml";
 	active_sheet.sql_column_names = sql_column_names;
 	active_sheet.sql_column_types = sql_column_types;
 
 	D_ASSERT(sql_column_names.size() == sql_column_types.size());
 	const auto column_count = sql_column_names.size();
 
-	// Generate sheet column names
-	active_sheet.sheet_column_names.resize(column_count);
-	for (idx_t col_idx = 0; col_idx < column_count; col_idx++) {
-		// Convert number to excel column name, e.g. 0 -> A, 1 -> B, 25 -> Z, 26 -> AA, etc.
-		string col_name;
-		idx_t col_num = col_idx + 1;
-		while (col_num > 0) {
-			col_name = static_cast<char>('A' + (col_num - 1) % 26) + col_name;
-			col_num = (col_num - 1) / 26;
-		}
-		active_sheet.sheet_column_names[col_idx] = col_name;
-	}
+	// Reset the row buffer for the columns of this sheet
+	rows = XLSXRowBuffer(column_count);
 
 	// Generate sheet column types
 	active_sheet.sheet_column_types.resize(column_count);
@@ -109,6 +389,14 @@ inline void XLXSWriter::BeginSheet(const string &sheet_name, const vector<string
 		}
 	}
 
+	rollover_base_name = sheet_name;
+	rollover_sheet_number = 1;
+	OpenSheetFile();
+}
+
+inline void XLXSWriter::OpenSheetFile() {
+	active_sheet.sheet_file = "sheet" + std::to_string(written_sheets.size() + 1) + ".xml";
+
 	static constexpr auto WORKSHEET_XML_START = R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
 	<worksheet xmlns="http://schemas.openxmlformats.org/spreadsheetml/2006/main"
 	           xmlns:r="http://schemas.openxmlformats.org/officeDocument/2006/relationships"
@@ -122,112 +410,240 @@ inline void XLXSWriter::BeginSheet(const string &sheet_name, const vector<string
 	<sheetData>
 	)";
 
-	stream.BeginFile("xl/worksheets/" + active_sheet.sheet_file);
+	// Worksheets are the bulk of the file, so they are deflated in blocks that other threads can help compress
+	stream.BeginParallelFile("xl/worksheets/" + active_sheet.sheet_file);
 	stream.Write(WORKSHEET_XML_START);
 }
 
 inline void XLXSWriter::EndSheet() {
 	D_ASSERT(has_active_sheet);
+	FlushRows();
 	has_active_sheet = false;
 
+	CloseSheetFile();
+	written_sheets.push_back(std::move(active_sheet));
+}
+
+inline void XLXSWriter::CloseSheetFile() {
 	static constexpr auto WORKSHEET_XML_END = R"(</sheetData></worksheet>)";
 	stream.Write(WORKSHEET_XML_END);
 	stream.EndFile();
 
-	// Save the sheet
-	written_sheets.push_back(std::move(active_sheet));
-
-	row_str = "1";
 	row_idx = 0;
-	col_idx = 0;
+	row_number.Reset();
 }
 
-inline void XLXSWriter::WriteNumberCell(const string_t &value) {
-	stream.Write("<c r=\"" + active_sheet.sheet_column_names[col_idx] + row_str + "\" t=\"n\"><v>");
-	stream.Write(value.GetData(), value.GetSize());
-	stream.Write("</v></c>");
+inline void XLXSWriter::RollOverSheet() {
+	CloseSheetFile();
+	written_sheets.push_back(active_sheet);
 
-	col_idx++;
+	active_sheet.sheet_name = GetRolloverSheetName();
+	OpenSheetFile();
+
+	if (!repeat_header_row) {
+		return;
+	}
+	row_idx++;
+	row_number.Increment();
+	output += "<row r=\"1\">";
+	for (idx_t col_idx = 0; col_idx < active_sheet.sql_column_names.size(); col_idx++) {
+		const auto &name = active_sheet.sql_column_names[col_idx];
+		output += rows.cell_prefixes[col_idx];
+		output += "1\" t=\"inlineStr\"><is><t>";
+		EscapeXMLString(name.c_str(), name.size(), escaped_buffer);
+		output.append(escaped_buffer.data(), escaped_buffer.size());
+		output += "</t></is></c>";
+	}
+	output += "</row>";
 }
 
-inline void XLXSWriter::WriteBooleanCell(const string_t &value) {
-	stream.Write("<c r=\"" + active_sheet.sheet_column_names[col_idx] + row_str + "\" t=\"b\" s=\"5\"><v>");
-	stream.Write(value.GetData(), value.GetSize());
-	stream.Write("</v></c>");
+inline string XLXSWriter::GetRolloverSheetName() {
+	while (true) {
+		const auto suffix = " (" + std::to_string(++rollover_sheet_number) + ")";
+
+		// Cut the base name short so that the name fits in the sheet name limit of excel, which counts UTF-16 code
+		// units, so characters outside of the basic multilingual plane count twice
+		const auto max_length = XLSX_MAX_SHEET_NAME_LENGTH - suffix.size();
+		idx_t length = 0;
+		idx_t name_end = 0;
+		while (name_end < rollover_base_name.size()) {
+			const auto c = static_cast<uint8_t>(rollover_base_name[name_end]);
+			const idx_t char_bytes = c < 0xC0 ? 1 : c < 0xE0 ? 2 : c < 0xF0 ? 3 : 4;
+			const idx_t char_length = char_bytes == 4 ? 2 : 1;
+			if (length + char_length > max_length) {
+				break;
+			}
+			length += char_length;
+			name_end = MinValue(name_end + char_bytes, rollover_base_name.size());
+		}
+		auto name = EscapeXMLString(rollover_base_name.substr(0, name_end) + suffix);
+
+		// Sheet names are case insensitive in excel
+		bool is_taken = false;
+		for (const auto &sheet : written_sheets) {
+			if (StringUtil::CIEquals(sheet.sheet_name, name)) {
+				is_taken = true;
+				break;
+			}
+		}
+		if (!is_taken) {
+			return name;
+		}
+	}
+}
 
-	col_idx++;
+inline void XLXSWriter::WriteNumberCell(const string_t &value) {
+	rows.WriteNumberCell(value);
+}
+
+inline void XLXSWriter::WriteBooleanCell(const string_t &value) {
+	rows.WriteBooleanCell(value);
 }
 
 inline void XLXSWriter::WriteInlineStringCell(const string_t &value) {
-	stream.Write("<c r=\"" + active_sheet.sheet_column_names[col_idx] + row_str + "\" t=\"inlineStr\"><is><t>");
-	// We need to escape this string in case it contains XML special characters
-	WriteEscapedXML(value.GetData(), value.GetSize());
-	stream.Write("</t></is></c>");
+	rows.WriteInlineStringCell(value);
+}
 
-	col_idx++;
+inline void XLXSWriter::WriteSharedStringCell(const string_t &value) {
+	rows.WriteSharedStringCell(value);
 }
 
 inline void XLXSWriter::WriteDateCell(const string_t &value) {
-	stream.Write("<c r=\"" + active_sheet.sheet_column_names[col_idx] + row_str + "\" t=\"n\" s=\"1\"><v>");
-	stream.Write(value.GetData(), value.GetSize());
-	stream.Write("</v></c>");
-
-	col_idx++;
+	rows.WriteDateCell(value);
 }
 
 inline void XLXSWriter::WriteTimeCell(const string_t &value) {
-	stream.Write("<c r=\"" + active_sheet.sheet_column_names[col_idx] + row_str + "\" t=\"n\" s=\"3\"><v>");
-	stream.Write(value.GetData(), value.GetSize());
-	stream.Write("</v></c>");
-
-	col_idx++;
+	rows.WriteTimeCell(value);
 }
 
 inline void XLXSWriter::WriteTimestampCell(const string_t &value) {
-	stream.Write("<c r=\"" + active_sheet.sheet_column_names[col_idx] + row_str + "\" t=\"n\" s=\"4\"><v>");
-	stream.Write(value.GetData(), value.GetSize());
-	stream.Write("</v></c>");
-
-	col_idx++;
+	rows.WriteTimestampCell(value);
 }
 
 inline void XLXSWriter::WriteTimestampCellNoMilliseconds(const string_t &value) {
-	stream.Write("<c r=\"" + active_sheet.sheet_column_names[col_idx] + row_str + "\" t=\"n\" s=\"2\"><v>");
-	stream.Write(value.GetData(), value.GetSize());
-	stream.Write("</v></c>");
-
-	col_idx++;
+	rows.WriteTimestampCellNoMilliseconds(value);
 }
 
 inline void XLXSWriter::WriteEmptyCell() {
-	col_idx++;
+	rows.WriteEmptyCell();
 }
 
 inline void XLXSWriter::BeginRow() {
-	stream.Write("<row r=\"" + row_str + "\">");
+	rows.BeginRow();
 }
 
 inline void XLXSWriter::EndRow() {
-	stream.Write("</row>");
-	col_idx = 0;
+	rows.EndRow();
+	if (rows.GetSizeInBytes() >= ROW_BUFFER_FLUSH_SIZE) {
+		FlushRows();
+	}
+}
 
-	row_idx++;
-	row_str = std::to_string(row_idx + 1);
-
-	if (row_idx > sheet_row_limit) {
-		if (sheet_row_limit >= XLSX_MAX_CELL_ROWS) {
-			const auto msg = "XLSX: Sheet row limit of '%d' rows exceeded!\n"
-			                 " * XLSX files and compatible applications generally have a limit of '%d' rows\n"
-			                 " * You can export larger sheets at your own risk by setting the 'sheet_row_limit' "
-			                 "parameter to a higher value";
-			throw InvalidInputException(msg, sheet_row_limit, XLSX_MAX_CELL_ROWS);
-		} else {
-			throw InvalidInputException("XLSX: Sheet row limit of '%d' rows exceeded!", sheet_row_limit);
+inline void XLXSWriter::FlushRows() {
+	WriteRows(rows);
+	rows.Clear();
+}
+
+inline void XLXSWriter::AppendRows(const XLSXRowBuffer &buffer) {
+	// Rows written cell by cell (e.g. the header) go first
+	if (rows.GetRowCount() != 0) {
+		FlushRows();
+	}
+	WriteRows(buffer);
+}
+
+inline void XLXSWriter::WriteRows(const XLSXRowBuffer &buffer) {
+	D_ASSERT(has_active_sheet);
+	const auto data = buffer.data.data();
+
+	// The strings of the buffer are resolved to shared strings as they are encountered
+	static constexpr auto UNRESOLVED = DConstants::INVALID_INDEX - 1;
+	resolved_strings.assign(buffer.strings.size(), UNRESOLVED);
+
+	// The rows are assembled in the output buffer, which is written to the sheet in large pieces
+	output.clear();
+
+	idx_t data_pos = 0;
+	idx_t gap_idx = 0;
+	for (const auto row_end : buffer.row_ends) {
+		row_idx++;
+		if (row_idx > sheet_row_limit && sheet_rollover) {
+			// Write out everything up to the start of this row, which is right in front of its row number
+			const auto row_start = buffer.gaps[gap_idx].offset - (sizeof("<row r=\"") - 1);
+			output.append(data + data_pos, row_start - data_pos);
+			data_pos = row_start;
+			stream.Write(output);
+			output.clear();
+
+			// The header of the next sheet ends up in the output buffer
+			RollOverSheet();
+			row_idx++;
+		}
+		if (row_idx > sheet_row_limit) {
+			if (sheet_rollover) {
+				throw InvalidInputException("XLSX: Sheet row limit of '%d' rows leaves no room for data rows",
+				                            sheet_row_limit);
+			}
+			if (sheet_row_limit >= XLSX_MAX_CELL_ROWS) {
+				const auto msg = "XLSX: Sheet row limit of '%d' rows exceeded!\n"
+				                 " * XLSX files and compatible applications generally have a limit of '%d' rows\n"
+				                 " * You can export larger sheets at your own risk by setting the 'sheet_row_limit' "
+				                 "parameter to a higher value";
+				throw InvalidInputException(msg, sheet_row_limit, XLSX_MAX_CELL_ROWS);
+			} else {
+				throw InvalidInputException("XLSX: Sheet row limit of '%d' rows exceeded!", sheet_row_limit);
+			}
+		}
+		row_number.Increment();
+
+		// Fill in the row number of the row and each of its cells, and the shared strings
+		for (; gap_idx < row_end; gap_idx++) {
+			const auto &gap = buffer.gaps[gap_idx];
+			output.append(data + data_pos, gap.offset - data_pos);
+			data_pos = gap.offset;
+			if (gap.string_idx == DConstants::INVALID_INDEX) {
+				output.append(row_number.GetData(), row_number.GetSize());
+				continue;
+			}
+
+			auto &ssi = resolved_strings[gap.string_idx];
+			const auto &str = buffer.strings[gap.string_idx];
+			if (ssi == UNRESOLVED) {
+				ssi = shared_strings.Find(string_t(str));
+				if (ssi == DConstants::INVALID_INDEX && shared_strings.GetSizeInBytes() < shared_strings_limit) {
+					try {
+						ssi = shared_strings.Add(string_t(str));
+					} catch (OutOfMemoryException &) {
+						// The reservation is only a hint, if the memory is not there after all stop growing the
+						// table and write the remaining new strings inline
+						shared_strings_limit = 0;
+					}
+				}
+			}
+			if (ssi == DConstants::INVALID_INDEX) {
+				// The shared string table is full, write the string inline instead
+				output += "t=\"inlineStr\"><is><t>";
+				EscapeXMLString(str.c_str(), str.size(), escaped_buffer);
+				output.append(escaped_buffer.data(), escaped_buffer.size());
+				output += "</t></is>";
+			} else {
+				output += "t=\"s\"><v>";
+				AppendUnsigned(output, ssi);
+				output += "</v>";
+				shared_string_refs++;
+			}
+		}
+
+		if (output.size() >= OUTPUT_BUFFER_SIZE) {
+			stream.Write(output);
+			output.clear();
 		}
 	}
+	output.append(data + data_pos, buffer.data.size() - data_pos);
+	stream.Write(output);
 }
 
-inline void XLXSWriter::Finish() {
+inline void XLXSWriter::Finish(const bool sync) {
 
 	WriteWorkbook();
 	WriteRels();
@@ -237,7 +653,7 @@ inline void XLXSWriter::Finish() {
 	WriteContentTypes();
 
 	// Done!
-	stream.Finalize();
+	stream.Finalize(sync);
 }
 
 inline idx_t XLXSWriter::WriteEscapedXML(const char *str) {
@@ -392,12 +808,20 @@ inline void XLXSWriter::WriteWorkbook() {
 }
 
 inline void XLXSWriter::WriteSharedStrings() {
-	// We dont use shared strings for now, but still create a dummy file
-	static constexpr auto SHARED_STRINGS_XML =
-	    R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?><sst xmlns="http://schemas.openxmlformats.org/spreadsheetml/2006/main" count="0" uniqueCount="0"/>)";
+	static constexpr auto SHARED_STRINGS_XML_START =
+	    R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?><sst xmlns="http://schemas.openxmlformats.org/spreadsheetml/2006/main" count="%d" uniqueCount="%d">)";
+	static constexpr auto SHARED_STRINGS_XML_END = R"(</sst>)";
 
+	// Even if we dont use any shared strings, we still create the (empty) file
 	stream.BeginFile("xl/sharedStrings.xml");
-	stream.Write(SHARED_STRINGS_XML);
+	stream.Write(StringUtil::Format(SHARED_STRINGS_XML_START, shared_string_refs, shared_strings.Count()));
+	for (idx_t i = 0; i < shared_strings.Count(); i++) {
+		const auto str = shared_strings.Get(i);
+		stream.Write("<si><t>");
+		WriteEscapedXML(str.GetData(), str.GetSize());
+		stream.Write("</t></si>");
+	}
+	stream.Write(SHARED_STRINGS_XML_END);
 	stream.EndFile();
 }
 
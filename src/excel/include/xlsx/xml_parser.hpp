@@ -31,6 +31,18 @@ protected:
 	bool IsSuspended() const {
 		return state == XMLParseResult::SUSPENDED;
 	}
+	XMLParseResult GetState() const {
+		return state;
+	}
+	// Used when invoking the callbacks directly instead of through expat (e.g. for binary xlsb sheets).
+	// Clears a resumable stop, returns false if the parser has been stopped for good.
+	bool BeginPush() {
+		if (state == XMLParseResult::ABORTED) {
+			return false;
+		}
+		state = XMLParseResult::OK;
+		return true;
+	}
 
 	virtual void OnResume() {
 	}
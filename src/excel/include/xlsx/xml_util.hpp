@@ -36,6 +36,18 @@ void EscapeXMLString(const char *ptr, const idx_t len, T &out) {
 	}
 }
 
+// Append the decimal digits of a number
+template <class T>
+void AppendUnsigned(T &out, idx_t value) {
+	char buffer[20];
+	auto ptr = buffer + sizeof(buffer);
+	do {
+		*--ptr = static_cast<char>('0' + value % 10);
+		value /= 10;
+	} while (value != 0);
+	out.append(ptr, buffer + sizeof(buffer));
+}
+
 inline string EscapeXMLString(const string &str) {
 	string result;
 	EscapeXMLString(str.c_str(), str.size(), result);
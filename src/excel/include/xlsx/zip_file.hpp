@@ -2,46 +2,128 @@
 
 #include "duckdb/common/typedefs.hpp"
 #include "duckdb/common/string.hpp"
+#include "duckdb/common/unique_ptr.hpp"
 #include "duckdb/common/vector.hpp"
+#include "duckdb/storage/buffer/buffer_handle.hpp"
 
 namespace duckdb {
 
+class BufferManager;
 class ClientContext;
+class FileHandle;
+class ZipBlockDeflater;
+class ZipFileReader;
 
 class ZipFileWriter {
 public:
-	ZipFileWriter(ClientContext &context, const string &file_name);
+	// Small writes are collected in a buffer of this size before they are compressed
+	static constexpr idx_t DEFAULT_WRITE_BUFFER_SIZE = 256 * 1024;
+	// The compressed data is collected in a buffer of this size before it is written to the file
+	static constexpr idx_t OUTPUT_BUFFER_SIZE = 2 * 1024 * 1024;
+
+	ZipFileWriter(ClientContext &context, const string &file_name,
+	              idx_t write_buffer_size = DEFAULT_WRITE_BUFFER_SIZE);
 	~ZipFileWriter();
 
 	// Delete copy
 	ZipFileWriter(const ZipFileWriter &) = delete;
 	ZipFileWriter &operator=(const ZipFileWriter &) = delete;
 
+	// Set the deflate level (1-9, or -1 for the default) of the entries opened from now on. Level 0 stores the entries
+	// without compressing them at all
+	void SetCompressionLevel(int16_t level);
+
 	void AddDirectory(const string &dir_name);
 	void BeginFile(const string &file_name);
+	// Begin an entry that is deflated in independent blocks, which can be compressed by multiple threads at once.
+	// Blocks are compressed by the writing thread once too many are waiting, unless other threads help out.
+	// Stored entries are written as is, as there is nothing to compress.
+	void BeginParallelFile(const string &file_name);
 	idx_t Write(const char *buffer, idx_t write_size);
 	idx_t Write(const string &str);
 	idx_t Write(const char *str);
 
+	// Compress the blocks of the current entry that are ready to be compressed. This can be called from any
+	// number of threads at once, also while another thread is writing to the entry
+	void CompressBlocks();
+
 	void EndFile();
-	void Finalize();
+	// Write the central directory and close the file, syncing it to disk only if requested
+	void Finalize(bool sync = false);
 
 private:
+	void FlushWriteBuffer();
+	idx_t WriteEntry(const char *buffer, idx_t write_size);
+
 	void *handle;
 	void *stream;
 	bool is_entry_open;
-	vector<char> escaped_buffer;
+	bool is_parallel_entry;
+	int16_t compression_level;
+	unique_ptr<ZipBlockDeflater> deflater;
+	string write_buffer;
+	idx_t write_buffer_size;
+};
+
+// Decides which entries of a streamed archive are kept in memory
+class ZipStreamFilter {
+public:
+	virtual ~ZipStreamFilter() = default;
+
+	// Whether to keep the entry, this is asked before its data is read
+	virtual bool KeepEntry(const string &name) = 0;
+	// Whether to hand the kept entry to OnEntry, so that it can affect which of the following entries are kept
+	virtual bool InspectEntry(const string &name) {
+		return false;
+	}
+	// Called with a reader that has the inspected entry open
+	virtual void OnEntry(const string &name, ZipFileReader &reader) {
+	}
+};
+
+// An archive buffered from a stream. The buffer is allocated by the buffer manager, so that it counts towards the
+// memory limit, and stays pinned for as long as this lives.
+class ZipStreamBuffer {
+public:
+	explicit ZipStreamBuffer(BufferManager &buffer_manager_p) : buffer_manager(buffer_manager_p) {
+	}
+
+	const char *GetData() const {
+		return const_char_ptr_cast(handle.Ptr());
+	}
+	idx_t GetSize() const {
+		return size;
+	}
+	void Append(const char *data, idx_t len);
+
+private:
+	static constexpr idx_t INITIAL_CAPACITY = 256 * 1024;
+
+	BufferManager &buffer_manager;
+	BufferHandle handle;
+	idx_t size = 0;
+	idx_t capacity = 0;
 };
 
 class ZipFileReader {
 public:
 	ZipFileReader(ClientContext &context, const string &file_name);
+	// Read an archive from memory, the buffer must outlive the reader
+	ZipFileReader(const char *data, idx_t size);
 	~ZipFileReader();
 
 	// Delete copy
 	ZipFileReader(const ZipFileReader &) = delete;
 	ZipFileReader &operator=(const ZipFileReader &) = delete;
 
+	// Allow move
+	ZipFileReader(ZipFileReader &&other) noexcept;
+
+	// Read an archive from a handle that can't seek (e.g. a pipe) by walking the local file headers in order,
+	// instead of starting from the central directory at the end. Only the entries accepted by the filter are kept,
+	// still compressed, and repacked into an archive that can be read with the in-memory constructor.
+	static ZipStreamBuffer BufferStream(BufferManager &buffer_manager, FileHandle &handle, ZipStreamFilter &filter);
+
 	bool TryOpenEntry(const string &file_name);
 	void CloseEntry();
 	idx_t Read(char *buffer, idx_t read_size);
@@ -50,6 +132,8 @@ public:
 	idx_t GetEntryPos() const;
 	// Returns the uncompressed size of the current entry
 	idx_t GetEntryLen() const;
+	// Returns the compressed size of the current entry
+	idx_t GetEntryCompressedLen() const;
 	// Returns if the current entry is done
 	bool IsDone() const;
 
@@ -60,6 +144,7 @@ private:
 
 	idx_t entry_pos;
 	idx_t entry_len;
+	idx_t entry_compressed_len;
 };
 
 } // namespace duckdb
\ No newline at end of file
@@ -0,0 +1,277 @@
+#include "xlsb/read_xlsb.hpp"
+#include "xlsb/record_reader.hpp"
+
+#include "xlsb/parsers/shared_strings_parser.hpp"
+#include "xlsb/parsers/stylesheet_parser.hpp"
+#include "xlsb/parsers/workbook_parser.hpp"
+#include "xlsb/parsers/worksheet_parser.hpp"
+
+#include "xlsx/read_xlsx.hpp"
+#include "xlsx/zip_file.hpp"
+#include "xlsx/string_table.hpp"
+#include "xlsx/parsers/relationship_parser.hpp"
+#include "xlsx/parsers/worksheet_parser.hpp"
+
+#include "duckdb/main/extension_util.hpp"
+#include "duckdb/main/query_result.hpp"
+#include "duckdb/parser/expression/constant_expression.hpp"
+#include "duckdb/parser/expression/function_expression.hpp"
+#include "duckdb/parser/tableref/table_function_ref.hpp"
+#include "duckdb/function/replacement_scan.hpp"
+#include "duckdb/storage/temporary_memory_manager.hpp"
+
+namespace duckdb {
+
+//-------------------------------------------------------------------
+// Meta
+//-------------------------------------------------------------------
+// An xlsb workbook has the same layout as a xlsx workbook, except that
+// the workbook, styles, shared strings and sheets are BIFF12 records
+// instead of XML. The relationships are still stored as XML.
+//-------------------------------------------------------------------
+static void ParseXLSBFileMeta(const unique_ptr<XLSXReadData> &result, ZipFileReader &reader) {
+	if (!reader.TryOpenEntry("xl/workbook.bin")) {
+		throw BinderException("No xl/workbook.bin found in xlsb file");
+	}
+	const auto sheets = XLSBWorkBookParser::GetSheets(reader);
+	reader.CloseEntry();
+
+	if (!reader.TryOpenEntry("xl/_rels/workbook.bin.rels")) {
+		throw BinderException("No xl/_rels/workbook.bin.rels found in xlsb file");
+	}
+	const auto wbrels = RelParser::ParseRelations(reader);
+	reader.CloseEntry();
+
+	ReadXLSX::SelectSheet(result, sheets, wbrels);
+}
+
+static void ParseStyleSheet(const unique_ptr<XLSXReadData> &result, ZipFileReader &archive) {
+	// Parse the styles (so we can handle dates)
+	if (archive.TryOpenEntry("xl/styles.bin")) {
+		result->style_sheet = XLSXStyleSheet(XLSBStyleParser::GetCellStyles(archive));
+		archive.CloseEntry();
+	}
+}
+
+static void ReadXLSBSheet(ZipFileReader &archive, SheetParserBase &parser) {
+	XLSBSheetReader reader(archive);
+	reader.ReadAll(parser);
+}
+
+static unordered_map<idx_t, string> SearchXLSBStrings(ZipFileReader &archive, const vector<idx_t> &ids) {
+	XLSBSharedStringSearcher searcher(ids);
+	searcher.ParseAll(archive);
+	return searcher.GetResult();
+}
+
+// Range and header sniffing is shared with the xlsx reader, only the way the sheets and strings are read differs
+static const XLSXWorkbookFormat XLSB_FORMAT = {"xlsb",
+                                               "xl/workbook.bin",
+                                               "xl/_rels/workbook.bin.rels",
+                                               "xl/sharedStrings.bin",
+                                               XLSBWorkBookParser::GetSheets,
+                                               ReadXLSBSheet,
+                                               SearchXLSBStrings};
+
+//-------------------------------------------------------------------
+// Bind
+//-------------------------------------------------------------------
+static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
+                                     vector<LogicalType> &return_types, vector<string> &names) {
+	auto result = make_uniq<XLSXReadData>();
+
+	// Parse the options
+	ReadXLSX::ParseOptions(result->options, input.named_parameters);
+
+	// Get the file name, or the file itself
+	ReadXLSX::BindInput(context, *result, input.inputs[0], input.table_function.name, XLSB_FORMAT);
+
+	// Open the archive
+	auto archive = ReadXLSX::OpenArchive(context, *result);
+
+	// Resolve the sheet
+	ParseXLSBFileMeta(result, archive);
+	ParseStyleSheet(result, archive);
+	if (!result->options.has_explicit_range) {
+		// Sniff content range if required
+		ReadXLSX::SniffRange(*result, archive, XLSB_FORMAT);
+	}
+	ReadXLSX::SniffHeader(*result, archive, XLSB_FORMAT);
+
+	return_types = result->return_types;
+	names = result->column_names;
+
+	// Deduplicate column names
+	QueryResult::DeduplicateColumns(names);
+
+	return std::move(result);
+}
+
+//-------------------------------------------------------------------
+// Global State
+//-------------------------------------------------------------------
+class XLSBGlobalState final : public GlobalTableFunctionState {
+public:
+	explicit XLSBGlobalState(ClientContext &context, const XLSXReadData &data, const XLSXCellRange &range,
+	                         bool stop_at_empty)
+	    : archive(ReadXLSX::OpenArchive(context, data)), reader(archive), strings(BufferManager::GetBufferManager(context)),
+	      parser(context, range, strings, stop_at_empty), cast_vec(LogicalType::DOUBLE) {
+		ReadXLSX::InitParser(data, parser);
+	}
+
+	ZipFileReader archive;
+	XLSBSheetReader reader;
+	StringTable strings;
+	// Memory reserved for the string table
+	unique_ptr<TemporaryMemoryState> strings_memory;
+	SheetParser parser;
+
+	XMLParseResult status = XMLParseResult::OK;
+
+	Vector cast_vec;
+
+	atomic<idx_t> stream_pos = {0};
+	idx_t stream_len = 0;
+};
+
+static unique_ptr<GlobalTableFunctionState> InitGlobal(ClientContext &context, TableFunctionInitInput &input) {
+	auto &data = input.bind_data->Cast<XLSXReadData>();
+	auto &options = data.options;
+	auto state = make_uniq<XLSBGlobalState>(context, data, data.options.range, options.stop_at_empty);
+
+	// Check if there is a string table. If there is, extract it
+	if (state->archive.TryOpenEntry("xl/sharedStrings.bin")) {
+		// The strings are stored as UTF-16 in the entry, so its size is a reasonable estimate for the size of the table
+		ReadXLSX::ReserveStringTable(context, state->strings, state->strings_memory, state->archive.GetEntryLen());
+
+		XLSBSharedStringParser::ParseStringTable(state->archive, state->strings);
+		state->archive.CloseEntry();
+
+		ReadXLSX::ShrinkStringTableReservation(context, state->strings, *state->strings_memory);
+	}
+
+	// Open the main sheet for reading
+	if (!state->archive.TryOpenEntry(data.sheet_path)) {
+		// This should never happen, we've already checked this in the bind function
+		throw InvalidInputException("Sheet '%s' not found in xlsb file", data.sheet_path);
+	}
+
+	// Set the progress counters
+	state->stream_len = state->archive.GetEntryLen();
+	state->stream_pos = 0;
+
+	return std::move(state);
+}
+
+//-------------------------------------------------------------------
+// Execute
+//-------------------------------------------------------------------
+static void Execute(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &bind_data = data.bind_data->Cast<XLSXReadData>();
+	auto &options = bind_data.options;
+	auto &gstate = data.global_state->Cast<XLSBGlobalState>();
+
+	auto &reader = gstate.reader;
+	auto &parser = gstate.parser;
+	auto &status = gstate.status;
+
+	// Ready the chunk
+	auto &chunk = parser.GetChunk();
+	parser.ResetChunk();
+
+	while (chunk.size() != STANDARD_VECTOR_SIZE) {
+		if (status == XMLParseResult::SUSPENDED && parser.FoundSkippedRow()) {
+			if (options.stop_at_empty) {
+				status = XMLParseResult::ABORTED;
+				break;
+			}
+			parser.SkipRows();
+			continue;
+		}
+		if (status == XMLParseResult::ABORTED) {
+			break;
+		}
+
+		// Otherwise, push more records into the parser (resuming it if it was suspended)
+		status = reader.Read(parser);
+	}
+
+	// Update the progress
+	gstate.stream_pos = reader.GetPosition();
+
+	// Pad with empty rows if wanted (and needed)
+	if (options.has_explicit_range) {
+		parser.FillRows();
+	}
+
+	ReadXLSX::CastChunk(context, bind_data, parser, gstate.cast_vec, output);
+}
+
+//-------------------------------------------------------------------
+// Progress
+//-------------------------------------------------------------------
+static double Progress(ClientContext &context, const FunctionData *bind_data_p,
+                       const GlobalTableFunctionState *global_state) {
+	if (!global_state) {
+		return 0;
+	}
+
+	const auto &state = global_state->Cast<XLSBGlobalState>();
+	const auto pos = static_cast<double>(state.stream_pos.load());
+	const auto len = static_cast<double>(state.stream_len);
+
+	return (pos == 0 || len == 0) ? 0 : (pos / len) * 100.0;
+}
+
+static unique_ptr<TableRef> XLSBReplacementScan(ClientContext &context, ReplacementScanInput &input,
+                                                optional_ptr<ReplacementScanData> data) {
+	const auto table_name = ReplacementScan::GetFullPath(input);
+	const auto lower_name = StringUtil::Lower(table_name);
+
+	if (!StringUtil::EndsWith(lower_name, ".xlsb")) {
+		return nullptr;
+	}
+
+	auto result = make_uniq<TableFunctionRef>();
+	vector<unique_ptr<ParsedExpression>> children;
+	children.push_back(make_uniq<ConstantExpression>(Value(table_name)));
+	result->function = make_uniq_base<ParsedExpression, FunctionExpression>("read_xlsb", std::move(children));
+
+	return std::move(result);
+}
+
+//-------------------------------------------------------------------
+// Register
+//-------------------------------------------------------------------
+TableFunction ReadXLSB::GetFunction() {
+
+	TableFunction read_xlsb("read_xlsb", {LogicalType::VARCHAR}, Execute, Bind);
+	read_xlsb.init_global = InitGlobal;
+	read_xlsb.table_scan_progress = Progress;
+
+	// Parameters, these are the same as for read_xlsx
+	read_xlsb.named_parameters["header"] = LogicalType::BOOLEAN;
+	read_xlsb.named_parameters["all_varchar"] = LogicalType::BOOLEAN;
+	read_xlsb.named_parameters["ignore_errors"] = LogicalType::BOOLEAN;
+	read_xlsb.named_parameters["range"] = LogicalType::VARCHAR;
+	read_xlsb.named_parameters["sheet"] = LogicalType::VARCHAR;
+	read_xlsb.named_parameters["stop_at_empty"] = LogicalType::BOOLEAN;
+	read_xlsb.named_parameters["empty_as_varchar"] = LogicalType::BOOLEAN;
+	read_xlsb.named_parameters["columns"] = LogicalType::ANY;
+	read_xlsb.named_parameters["types"] = LogicalType::LIST(LogicalType::VARCHAR);
+
+	return read_xlsb;
+}
+
+void ReadXLSB::Register(DatabaseInstance &db) {
+	TableFunctionSet read_xlsb("read_xlsb");
+	auto read_file = GetFunction();
+	auto read_blob = read_file;
+	read_blob.arguments = {LogicalType::BLOB};
+	read_xlsb.AddFunction(std::move(read_file));
+	read_xlsb.AddFunction(std::move(read_blob));
+	ExtensionUtil::RegisterFunction(db, read_xlsb);
+	db.config.replacement_scans.emplace_back(XLSBReplacementScan);
+}
+
+} // namespace duckdb
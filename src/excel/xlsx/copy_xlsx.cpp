@@ -1,83 +1,150 @@
 #include "duckdb/common/exception/conversion_exception.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/operator/multiply.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
 #include "duckdb/function/copy_function.hpp"
 #include "duckdb/main/database.hpp"
 #include "duckdb/main/extension_util.hpp"
 #include "duckdb/planner/expression/bound_cast_expression.hpp"
-#include "duckdb/planner/expression/bound_function_expression.hpp"
 #include "duckdb/planner/expression/bound_reference_expression.hpp"
 #include "xlsx/read_xlsx.hpp"
 #include "xlsx/xlsx_writer.hpp"
 
+#include "fmt/format.h"
+
+#include <cmath>
+
 namespace duckdb {
 
 //------------------------------------------------------------------------------
-// Conversion Expressions
+// Number Formatting
+//------------------------------------------------------------------------------
+// Numbers, booleans and temporal values are formatted straight from the
+// vector data, without casting them to VARCHAR first. Temporal values
+// are converted to excel "serial" numbers, the number of days since
+// 1900-01-01. Values that can't be represented in excel (NaN, infinity)
+// are left empty, signalled by returning INVALID_INDEX as the length.
 //------------------------------------------------------------------------------
 static constexpr auto DAYS_BETWEEN_1900_AND_1970 = 25569;
 static constexpr auto SECONDS_PER_DAY = 86400;
+static constexpr idx_t NUMBER_BUFFER_SIZE = 64;
+
+static idx_t FormatUnsigned(uint64_t value, char *out) {
+	char buffer[20];
+	auto ptr = buffer + sizeof(buffer);
+	do {
+		*--ptr = static_cast<char>('0' + value % 10);
+		value /= 10;
+	} while (value != 0);
+	const auto len = static_cast<idx_t>(buffer + sizeof(buffer) - ptr);
+	memcpy(out, ptr, len);
+	return len;
+}
 
-static void TimestampToExcelNumberFunction(DataChunk &args, ExpressionState &state, Vector &result) {
-	const auto count = args.size();
-	UnaryExecutor::Execute<timestamp_t, double>(args.data[0], result, count, [&](timestamp_t timestamp) {
-		const auto epoch_us = Timestamp::GetEpochMicroSeconds(timestamp);
-		// Turn ms to seconds
-		const auto epoch_s = static_cast<double>(epoch_us) / 1000000.0;
-		// Add the seconds to the days
-		const auto res = epoch_s / SECONDS_PER_DAY + DAYS_BETWEEN_1900_AND_1970;
-		return res;
-	});
+static idx_t FormatSigned(int64_t value, char *out) {
+	if (value >= 0) {
+		return FormatUnsigned(static_cast<uint64_t>(value), out);
+	}
+	out[0] = '-';
+	return FormatUnsigned(~static_cast<uint64_t>(value) + 1, out + 1) + 1;
 }
 
-static void TimeToExcelNumberFunction(DataChunk &args, ExpressionState &state, Vector &result) {
-	const auto count = args.size();
-	UnaryExecutor::Execute<dtime_t, double>(args.data[0], result, count, [&](dtime_t time) {
-		// 1.0 is a full day;
-		return static_cast<double>(time.micros) / Interval::MICROS_PER_DAY;
-	});
+template <class T>
+static idx_t FormatFloatingPoint(T value, char *out) {
+	if (!Value::IsFinite(value)) {
+		return DConstants::INVALID_INDEX;
+	}
+	// Whole numbers are written without a fractional part, e.g. "2999" instead of "2999.0"
+	if (value == std::floor(value) && std::fabs(value) < 9007199254740992.0) {
+		return FormatSigned(static_cast<int64_t>(value), out);
+	}
+	// Otherwise, write the shortest representation that round-trips
+	const auto result = duckdb_fmt::format_to_n(out, NUMBER_BUFFER_SIZE, "{}", value);
+	return result.size;
 }
 
-static void DateToExcelNumberFunction(DataChunk &args, ExpressionState &state, Vector &result) {
-	const auto count = args.size();
-	UnaryExecutor::Execute<date_t, double>(args.data[0], result, count, [&](date_t date) {
-		// Date only has days, so there is no need to get more precision
-		const auto epoch_s = Date::Epoch(date);
-		// Add the seconds to the days
-		const auto res = epoch_s / SECONDS_PER_DAY + DAYS_BETWEEN_1900_AND_1970;
-		return res;
-	});
+static idx_t FormatDecimal(int64_t value, const uint8_t scale, char *out) {
+	idx_t len = 0;
+	if (value < 0) {
+		out[len++] = '-';
+	}
+	const auto abs_value = value < 0 ? ~static_cast<uint64_t>(value) + 1 : static_cast<uint64_t>(value);
+
+	uint64_t power = 1;
+	for (uint8_t i = 0; i < scale; i++) {
+		power *= 10;
+	}
+	len += FormatUnsigned(abs_value / power, out + len);
+
+	// Write the fraction without trailing zeros, e.g. "12.5" instead of "12.50"
+	auto fraction = abs_value % power;
+	if (fraction == 0) {
+		return len;
+	}
+	auto digits = scale;
+	while (fraction % 10 == 0) {
+		fraction /= 10;
+		digits--;
+	}
+	out[len++] = '.';
+	for (auto i = digits; i > 0; i--) {
+		out[len + i - 1] = static_cast<char>('0' + fraction % 10);
+		fraction /= 10;
+	}
+	return len + digits;
 }
 
-static unique_ptr<Expression> TimestampConversionExpr(unique_ptr<Expression> ref) {
-	vector<unique_ptr<Expression>> children;
-	children.push_back(std::move(ref));
+static idx_t FormatDate(const date_t date, char *out) {
+	if (!Date::IsFinite(date)) {
+		return DConstants::INVALID_INDEX;
+	}
+	// Date only has days, so there is no need to get more precision
+	return FormatSigned(static_cast<int64_t>(date.days) + DAYS_BETWEEN_1900_AND_1970, out);
+}
 
-	ScalarFunction sfunc("timestamp_to_excel_number", {LogicalType::TIMESTAMP}, LogicalType::DOUBLE,
-	                     TimestampToExcelNumberFunction);
-	auto func = make_uniq<BoundFunctionExpression>(LogicalType::DOUBLE, sfunc, std::move(children), nullptr);
-	return std::move(func);
+static idx_t FormatTimestamp(const int64_t epoch_us, char *out) {
+	// Turn microseconds to seconds, and add them to the days
+	const auto epoch_s = static_cast<double>(epoch_us) / 1000000.0;
+	return FormatFloatingPoint(epoch_s / SECONDS_PER_DAY + DAYS_BETWEEN_1900_AND_1970, out);
 }
 
-static unique_ptr<Expression> TimeConversionExpr(unique_ptr<Expression> ref) {
-	vector<unique_ptr<Expression>> children;
-	children.push_back(std::move(ref));
+static idx_t FormatTime(const dtime_t time, char *out) {
+	// 1.0 is a full day
+	return FormatFloatingPoint(static_cast<double>(time.micros) / Interval::MICROS_PER_DAY, out);
+}
 
-	ScalarFunction sfunc("time_to_excel_number", {LogicalType::TIME}, LogicalType::DOUBLE, TimeToExcelNumberFunction);
-	auto func = make_uniq<BoundFunctionExpression>(LogicalType::DOUBLE, sfunc, std::move(children), nullptr);
-	return std::move(func);
+// All timestamp types are stored as a 64 bit number of units since the epoch, which we convert to microseconds
+template <int64_t MULTIPLIER, int64_t DIVISOR>
+static idx_t FormatTimestampUnits(const timestamp_t timestamp, char *out) {
+	if (!Timestamp::IsFinite(timestamp)) {
+		return DConstants::INVALID_INDEX;
+	}
+	int64_t epoch_us;
+	if (!TryMultiplyOperator::Operation<int64_t, int64_t, int64_t>(timestamp.value, MULTIPLIER, epoch_us)) {
+		throw ConversionException("Timestamp value %d is out of range for a TIMESTAMP", timestamp.value);
+	}
+	return FormatTimestamp(epoch_us / DIVISOR, out);
 }
 
-static unique_ptr<Expression> DateConversionExpr(unique_ptr<Expression> ref) {
-	vector<unique_ptr<Expression>> children;
-	children.push_back(std::move(ref));
+template <class T>
+static idx_t FormatInteger(const T value, char *out) {
+	if (std::is_signed<T>::value) {
+		return FormatSigned(static_cast<int64_t>(value), out);
+	}
+	return FormatUnsigned(static_cast<uint64_t>(value), out);
+}
 
-	ScalarFunction sfunc("date_to_excel_number", {LogicalType::DATE}, LogicalType::DOUBLE, DateToExcelNumberFunction);
-	auto func = make_uniq<BoundFunctionExpression>(LogicalType::DOUBLE, sfunc, std::move(children), nullptr);
-	return std::move(func);
+static idx_t FormatBoolean(const bool value, char *out) {
+	out[0] = value ? '1' : '0';
+	return 1;
 }
 
 //------------------------------------------------------------------------------
 // Bind
 //------------------------------------------------------------------------------
+// Whether string cells are written to the shared string table, AUTO only does so for columns with repeated values
+enum class XLSXSharedStringMode : uint8_t { NEVER, AUTO, ALWAYS };
+
 struct WriteXLSXData final : TableFunctionData {
 	vector<LogicalType> column_types;
 	vector<string> column_names;
@@ -85,7 +152,18 @@ struct WriteXLSXData final : TableFunctionData {
 	string file_path;
 	string sheet_name;
 	idx_t sheet_row_limit;
+	// Continue in a new sheet once the row limit is reached, instead of throwing
+	bool sheet_rollover;
 	bool header;
+	XLSXSharedStringMode shared_strings;
+	// The deflate level, 0 stores the parts of the workbook uncompressed and -1 uses the default level
+	int16_t compression_level;
+	// Continue in a new file once a file holds this many rows
+	optional_idx rows_per_file;
+	// The size of the buffer collecting small writes before they are compressed
+	idx_t write_buffer_size;
+	// Sync the written files to disk before the copy completes
+	bool sync;
 };
 
 static void ParseCopyToOptions(const unique_ptr<WriteXLSXData> &data,
@@ -144,6 +222,137 @@ static void ParseCopyToOptions(const unique_ptr<WriteXLSXData> &data,
 	} else {
 		data->sheet_row_limit = XLSX_MAX_CELL_ROWS;
 	}
+
+	// Find the sheet rollover option
+	const auto sheet_rollover_opt = options.find("sheet_rollover");
+	if (sheet_rollover_opt != options.end()) {
+		if (sheet_rollover_opt->second.size() != 1) {
+			throw BinderException("Sheet rollover option must be a single boolean value");
+		}
+		string error_msg;
+		Value bool_val;
+		if (!sheet_rollover_opt->second.back().DefaultTryCastAs(LogicalType::BOOLEAN, bool_val, &error_msg)) {
+			throw BinderException("Sheet rollover option must be a single boolean value");
+		}
+		if (bool_val.IsNull()) {
+			throw BinderException("Sheet rollover option must be a single boolean value");
+		}
+		data->sheet_rollover = BooleanValue::Get(bool_val);
+	} else {
+		data->sheet_rollover = false;
+	}
+	if (data->sheet_rollover && data->sheet_row_limit <= (data->header ? 1 : 0)) {
+		throw BinderException("Sheet row limit must leave room for at least one data row when sheet rollover is enabled");
+	}
+
+	// Find the shared strings option
+	const auto shared_strings_opt = options.find("shared_strings");
+	if (shared_strings_opt != options.end()) {
+		if (shared_strings_opt->second.size() != 1) {
+			throw BinderException("Shared strings option must be a single boolean value or 'auto'");
+		}
+		const auto &val = shared_strings_opt->second.back();
+		string error_msg;
+		Value bool_val;
+		if (val.type().id() == LogicalTypeId::VARCHAR && !val.IsNull() &&
+		    StringUtil::CIEquals(StringValue::Get(val), "auto")) {
+			data->shared_strings = XLSXSharedStringMode::AUTO;
+		} else if (val.DefaultTryCastAs(LogicalType::BOOLEAN, bool_val, &error_msg) && !bool_val.IsNull()) {
+			data->shared_strings =
+			    BooleanValue::Get(bool_val) ? XLSXSharedStringMode::ALWAYS : XLSXSharedStringMode::NEVER;
+		} else {
+			throw BinderException("Shared strings option must be a single boolean value or 'auto'");
+		}
+	} else {
+		data->shared_strings = XLSXSharedStringMode::AUTO;
+	}
+
+	// Find the compression option
+	const auto compression_opt = options.find("compression");
+	if (compression_opt != options.end()) {
+		const auto error_msg = "Compression option must be 'stored', 'fast', 'default', 'best' or a level from 0 to 9";
+		if (compression_opt->second.size() != 1) {
+			throw BinderException(error_msg);
+		}
+		const auto &val = compression_opt->second.back();
+		if (val.IsNull()) {
+			throw BinderException(error_msg);
+		}
+		const auto name = val.type().id() == LogicalTypeId::VARCHAR ? StringUtil::Lower(StringValue::Get(val)) : "";
+		Value int_val;
+		string cast_error;
+		if (name == "stored") {
+			data->compression_level = 0;
+		} else if (name == "fast") {
+			data->compression_level = 1;
+		} else if (name == "default") {
+			data->compression_level = -1;
+		} else if (name == "best") {
+			data->compression_level = 9;
+		} else if (val.DefaultTryCastAs(LogicalType::INTEGER, int_val, &cast_error) && !int_val.IsNull() &&
+		           IntegerValue::Get(int_val) >= 0 && IntegerValue::Get(int_val) <= 9) {
+			data->compression_level = static_cast<int16_t>(IntegerValue::Get(int_val));
+		} else {
+			throw BinderException(error_msg);
+		}
+	} else {
+		data->compression_level = -1;
+	}
+
+	// Find the rows per file option
+	const auto rows_per_file_opt = options.find("rows_per_file");
+	if (rows_per_file_opt != options.end()) {
+		if (rows_per_file_opt->second.size() != 1) {
+			throw BinderException("Rows per file option must be a single positive integer value");
+		}
+		string error_msg;
+		Value int_val;
+		if (!rows_per_file_opt->second.back().DefaultTryCastAs(LogicalType::BIGINT, int_val, &error_msg)) {
+			throw BinderException("Rows per file option must be a single positive integer value");
+		}
+		if (int_val.IsNull() || BigIntValue::Get(int_val) <= 0) {
+			throw BinderException("Rows per file option must be a single positive integer value");
+		}
+		data->rows_per_file = NumericCast<idx_t>(BigIntValue::Get(int_val));
+	}
+
+	// Find the write buffer size option
+	const auto write_buffer_size_opt = options.find("write_buffer_size");
+	if (write_buffer_size_opt != options.end()) {
+		if (write_buffer_size_opt->second.size() != 1) {
+			throw BinderException("Write buffer size option must be a single positive integer value");
+		}
+		string error_msg;
+		Value int_val;
+		if (!write_buffer_size_opt->second.back().DefaultTryCastAs(LogicalType::BIGINT, int_val, &error_msg)) {
+			throw BinderException("Write buffer size option must be a single positive integer value");
+		}
+		if (int_val.IsNull() || BigIntValue::Get(int_val) <= 0) {
+			throw BinderException("Write buffer size option must be a single positive integer value");
+		}
+		data->write_buffer_size = NumericCast<idx_t>(BigIntValue::Get(int_val));
+	} else {
+		data->write_buffer_size = ZipFileWriter::DEFAULT_WRITE_BUFFER_SIZE;
+	}
+
+	// Find the sync option
+	const auto sync_opt = options.find("sync");
+	if (sync_opt != options.end()) {
+		if (sync_opt->second.size() != 1) {
+			throw BinderException("Sync option must be a single boolean value");
+		}
+		string error_msg;
+		Value bool_val;
+		if (!sync_opt->second.back().DefaultTryCastAs(LogicalType::BOOLEAN, bool_val, &error_msg)) {
+			throw BinderException("Sync option must be a single boolean value");
+		}
+		if (bool_val.IsNull()) {
+			throw BinderException("Sync option must be a single boolean value");
+		}
+		data->sync = BooleanValue::Get(bool_val);
+	} else {
+		data->sync = false;
+	}
 }
 
 static unique_ptr<FunctionData> Bind(ClientContext &context, CopyFunctionBindInput &input, const vector<string> &names,
@@ -160,59 +369,354 @@ static unique_ptr<FunctionData> Bind(ClientContext &context, CopyFunctionBindInp
 	return std::move(data);
 }
 
+//------------------------------------------------------------------------------
+// Shared String Decisions
+//------------------------------------------------------------------------------
+// In AUTO mode, whether the strings of a column go to the shared string
+// table is decided once per file, from the first sample of the column
+// that completes. The serializers of all threads and batches follow
+// that decision, so that a column of mostly distinct strings does not
+// add another sample worth of strings to the table for every batch.
+//------------------------------------------------------------------------------
+struct XLSXSharedStringDecisions {
+	explicit XLSXSharedStringDecisions(idx_t column_count) : decided(column_count, false), share(column_count, true) {
+	}
+
+	// Returns whether the column has been decided, and if so, whether to share its strings
+	bool TryGet(idx_t col_idx, bool &result) {
+		lock_guard<mutex> guard(lock);
+		result = share[col_idx];
+		return decided[col_idx];
+	}
+
+	// Decide the column if no other serializer beat us to it, returns the decision that holds
+	bool Decide(idx_t col_idx, bool share_strings) {
+		lock_guard<mutex> guard(lock);
+		if (!decided[col_idx]) {
+			decided[col_idx] = true;
+			share[col_idx] = share_strings;
+		}
+		return share[col_idx];
+	}
+
+	mutex lock;
+	vector<bool> decided;
+	vector<bool> share;
+};
+
+//------------------------------------------------------------------------------
+// Serialize
+//------------------------------------------------------------------------------
+// Serializes chunks as rows. Numbers, booleans and temporal values are
+// formatted directly from the vector data, everything else is cast to
+// VARCHAR first. Every thread has its own serializer, so that rows can
+// be serialized in parallel, and only appending them to the sheet is
+// serialized.
+//------------------------------------------------------------------------------
+class XLSXChunkSerializer {
+public:
+	// Write a non-null cell of a column, these are picked per column up front so that we dont switch on the type of
+	// every cell
+	typedef void (*write_cell_t)(XLSXChunkSerializer &serializer, idx_t col_idx, const UnifiedVectorFormat &format,
+	                             idx_t row_idx, XLSXRowBuffer &rows);
+	// Returns nullptr if the column has to be cast first
+	static write_cell_t GetNativeCellWriter(const LogicalType &type);
+	// The type to cast a column to if it can't be written natively. Time zone aware values are cast to their local
+	// time (in the time zone of the session, if ICU is loaded), everything else to VARCHAR
+	static LogicalType GetCastType(const LogicalType &type);
+
+	XLSXChunkSerializer(ClientContext &context, const WriteXLSXData &data_p,
+	                    const vector<unique_ptr<Expression>> &conversion_expressions,
+	                    shared_ptr<XLSXSharedStringDecisions> string_decisions_p)
+	    : data(data_p), executor(context), string_decisions(std::move(string_decisions_p)) {
+		for (auto &expr : conversion_expressions) {
+			expressions.push_back(expr->Copy());
+			executor.AddExpression(*expressions.back());
+		}
+		if (!conversion_expressions.empty()) {
+			vector<LogicalType> types;
+			for (auto &expr : conversion_expressions) {
+				types.push_back(expr->return_type);
+			}
+			cast_chunk.Initialize(BufferAllocator::Get(context), types);
+		}
+
+		const auto column_count = data.column_types.size();
+		share_strings.resize(column_count, data.shared_strings != XLSXSharedStringMode::NEVER);
+		string_samples.resize(column_count);
+
+		// Columns that are not written natively are cast in order, see GlobalWriteXLSXData
+		idx_t cast_count = 0;
+		for (auto &type : data.column_types) {
+			auto writer = GetNativeCellWriter(type);
+			if (writer) {
+				cast_columns.push_back(DConstants::INVALID_INDEX);
+			} else {
+				cast_columns.push_back(cast_count++);
+				writer = GetNativeCellWriter(GetCastType(type));
+				if (!writer) {
+					writer = type.IsNumeric() ? WriteCastCell<&XLSXRowBuffer::WriteNumberCell> : WriteStringCell;
+				}
+			}
+			cell_writers.push_back(writer);
+		}
+		D_ASSERT(cast_count == conversion_expressions.size());
+
+		if (data.shared_strings == XLSXSharedStringMode::AUTO) {
+			for (auto &writer : cell_writers) {
+				undecided_columns += writer == WriteStringCell;
+			}
+		}
+	}
+
+	void Serialize(DataChunk &input, XLSXRowBuffer &rows);
+
+private:
+	template <class T, idx_t (*FORMAT)(T, char *), void (XLSXRowBuffer::*WRITE_CELL)(const string_t &)>
+	static void WriteNativeCell(XLSXChunkSerializer &serializer, idx_t col_idx, const UnifiedVectorFormat &format,
+	                            idx_t row_idx, XLSXRowBuffer &rows) {
+		const auto len = FORMAT(UnifiedVectorFormat::GetData<T>(format)[row_idx], serializer.number_buffer);
+		if (len == DConstants::INVALID_INDEX) {
+			rows.WriteEmptyCell();
+			return;
+		}
+		(rows.*WRITE_CELL)(string_t(serializer.number_buffer, UnsafeNumericCast<uint32_t>(len)));
+	}
+	template <class T>
+	static void WriteDecimalCell(XLSXChunkSerializer &serializer, idx_t col_idx, const UnifiedVectorFormat &format,
+	                             idx_t row_idx, XLSXRowBuffer &rows) {
+		const auto scale = DecimalType::GetScale(serializer.data.column_types[col_idx]);
+		const auto value = static_cast<int64_t>(UnifiedVectorFormat::GetData<T>(format)[row_idx]);
+		const auto len = FormatDecimal(value, scale, serializer.number_buffer);
+		rows.WriteNumberCell(string_t(serializer.number_buffer, UnsafeNumericCast<uint32_t>(len)));
+	}
+	template <void (XLSXRowBuffer::*WRITE_CELL)(const string_t &)>
+	static void WriteCastCell(XLSXChunkSerializer &serializer, idx_t col_idx, const UnifiedVectorFormat &format,
+	                          idx_t row_idx, XLSXRowBuffer &rows) {
+		(rows.*WRITE_CELL)(UnifiedVectorFormat::GetData<string_t>(format)[row_idx]);
+	}
+	static void WriteStringCell(XLSXChunkSerializer &serializer, idx_t col_idx, const UnifiedVectorFormat &format,
+	                            idx_t row_idx, XLSXRowBuffer &rows);
+	// Follow the decisions other serializers have made on sharing the strings of the columns we are still sampling
+	void FetchSharedStringDecisions();
+
+	const WriteXLSXData &data;
+	// Copies of the conversion expressions, as a local state can outlive the global state it was first used with when
+	// files are rotated
+	vector<unique_ptr<Expression>> expressions;
+	ExpressionExecutor executor;
+	DataChunk cast_chunk;
+	// The index of each column in the cast chunk, if it is cast
+	vector<idx_t> cast_columns;
+	vector<UnifiedVectorFormat> formats;
+	vector<write_cell_t> cell_writers;
+	char number_buffer[NUMBER_BUFFER_SIZE];
+
+	// Whether to write the strings of each column to the shared string table. In AUTO mode we sample the first
+	// strings of each column, and stop sharing them if most are distinct, as they would only grow the table. The
+	// first sample to complete decides the column for every serializer writing to the same file
+	static constexpr idx_t SHARED_STRINGS_SAMPLE_SIZE = STANDARD_VECTOR_SIZE;
+	struct StringSample {
+		idx_t cells = 0;
+		idx_t distinct = 0;
+	};
+	vector<bool> share_strings;
+	vector<StringSample> string_samples;
+	shared_ptr<XLSXSharedStringDecisions> string_decisions;
+	idx_t undecided_columns = 0;
+};
+
+XLSXChunkSerializer::write_cell_t XLSXChunkSerializer::GetNativeCellWriter(const LogicalType &type) {
+	switch (type.id()) {
+	case LogicalTypeId::BOOLEAN:
+		return WriteNativeCell<bool, FormatBoolean, &XLSXRowBuffer::WriteBooleanCell>;
+	case LogicalTypeId::DATE:
+		return WriteNativeCell<date_t, FormatDate, &XLSXRowBuffer::WriteDateCell>;
+	case LogicalTypeId::TIME:
+		return WriteNativeCell<dtime_t, FormatTime, &XLSXRowBuffer::WriteTimeCell>;
+	case LogicalTypeId::TIMESTAMP:
+		return WriteNativeCell<timestamp_t, FormatTimestampUnits<1, 1>, &XLSXRowBuffer::WriteTimestampCell>;
+	case LogicalTypeId::TIMESTAMP_MS:
+		return WriteNativeCell<timestamp_t, FormatTimestampUnits<Interval::MICROS_PER_MSEC, 1>,
+		                       &XLSXRowBuffer::WriteTimestampCell>;
+	case LogicalTypeId::TIMESTAMP_NS:
+		return WriteNativeCell<timestamp_t, FormatTimestampUnits<1, Interval::NANOS_PER_MICRO>,
+		                       &XLSXRowBuffer::WriteTimestampCell>;
+	case LogicalTypeId::TIMESTAMP_SEC:
+		// Style this differently (no milliseconds)
+		return WriteNativeCell<timestamp_t, FormatTimestampUnits<Interval::MICROS_PER_SEC, 1>,
+		                       &XLSXRowBuffer::WriteTimestampCellNoMilliseconds>;
+	case LogicalTypeId::TINYINT:
+		return WriteNativeCell<int8_t, FormatInteger<int8_t>, &XLSXRowBuffer::WriteNumberCell>;
+	case LogicalTypeId::SMALLINT:
+		return WriteNativeCell<int16_t, FormatInteger<int16_t>, &XLSXRowBuffer::WriteNumberCell>;
+	case LogicalTypeId::INTEGER:
+		return WriteNativeCell<int32_t, FormatInteger<int32_t>, &XLSXRowBuffer::WriteNumberCell>;
+	case LogicalTypeId::BIGINT:
+		return WriteNativeCell<int64_t, FormatInteger<int64_t>, &XLSXRowBuffer::WriteNumberCell>;
+	case LogicalTypeId::UTINYINT:
+		return WriteNativeCell<uint8_t, FormatInteger<uint8_t>, &XLSXRowBuffer::WriteNumberCell>;
+	case LogicalTypeId::USMALLINT:
+		return WriteNativeCell<uint16_t, FormatInteger<uint16_t>, &XLSXRowBuffer::WriteNumberCell>;
+	case LogicalTypeId::UINTEGER:
+		return WriteNativeCell<uint32_t, FormatInteger<uint32_t>, &XLSXRowBuffer::WriteNumberCell>;
+	case LogicalTypeId::UBIGINT:
+		return WriteNativeCell<uint64_t, FormatInteger<uint64_t>, &XLSXRowBuffer::WriteNumberCell>;
+	case LogicalTypeId::FLOAT:
+		return WriteNativeCell<float, FormatFloatingPoint<float>, &XLSXRowBuffer::WriteNumberCell>;
+	case LogicalTypeId::DOUBLE:
+		return WriteNativeCell<double, FormatFloatingPoint<double>, &XLSXRowBuffer::WriteNumberCell>;
+	case LogicalTypeId::DECIMAL:
+		switch (type.InternalType()) {
+		case PhysicalType::INT16:
+			return WriteDecimalCell<int16_t>;
+		case PhysicalType::INT32:
+			return WriteDecimalCell<int32_t>;
+		case PhysicalType::INT64:
+			return WriteDecimalCell<int64_t>;
+		default:
+			// Wider decimals are cast to VARCHAR
+			return nullptr;
+		}
+	default:
+		// HUGEINT and UHUGEINT are cast as well, they are rare enough
+		return nullptr;
+	}
+}
+
+LogicalType XLSXChunkSerializer::GetCastType(const LogicalType &type) {
+	switch (type.id()) {
+	case LogicalTypeId::TIMESTAMP_TZ:
+		return LogicalType::TIMESTAMP;
+	case LogicalTypeId::TIME_TZ:
+		return LogicalType::TIME;
+	default:
+		return LogicalType::VARCHAR;
+	}
+}
+
+void XLSXChunkSerializer::WriteStringCell(XLSXChunkSerializer &serializer, const idx_t col_idx,
+                                          const UnifiedVectorFormat &format, const idx_t row_idx,
+                                          XLSXRowBuffer &rows) {
+	const auto &value = UnifiedVectorFormat::GetData<string_t>(format)[row_idx];
+	if (!serializer.share_strings[col_idx]) {
+		rows.WriteInlineStringCell(value);
+		return;
+	}
+
+	const auto is_new = rows.WriteSharedStringCell(value);
+	if (serializer.data.shared_strings != XLSXSharedStringMode::AUTO) {
+		return;
+	}
+
+	auto &sample = serializer.string_samples[col_idx];
+	if (sample.cells == SHARED_STRINGS_SAMPLE_SIZE) {
+		// Already decided
+		return;
+	}
+	sample.cells++;
+	sample.distinct += is_new;
+	if (sample.cells == SHARED_STRINGS_SAMPLE_SIZE) {
+		const auto share = sample.distinct * 2 <= sample.cells;
+		serializer.share_strings[col_idx] = serializer.string_decisions->Decide(col_idx, share);
+		serializer.undecided_columns--;
+	}
+}
+
+void XLSXChunkSerializer::FetchSharedStringDecisions() {
+	for (idx_t col_idx = 0; col_idx < cell_writers.size(); col_idx++) {
+		auto &sample = string_samples[col_idx];
+		if (cell_writers[col_idx] != WriteStringCell || sample.cells == SHARED_STRINGS_SAMPLE_SIZE) {
+			continue;
+		}
+		bool share;
+		if (string_decisions->TryGet(col_idx, share)) {
+			share_strings[col_idx] = share;
+			sample.cells = SHARED_STRINGS_SAMPLE_SIZE;
+			undecided_columns--;
+		}
+	}
+}
+
+void XLSXChunkSerializer::Serialize(DataChunk &input, XLSXRowBuffer &rows) {
+	const auto row_count = input.size();
+	const auto col_count = input.data.size();
+
+	if (undecided_columns != 0) {
+		FetchSharedStringDecisions();
+	}
+
+	// First, cast the columns that we cant write natively to VARCHAR
+	if (cast_chunk.ColumnCount() != 0) {
+		cast_chunk.Reset();
+		executor.Execute(input, cast_chunk);
+	}
+
+	// Then, setup unified formats for the columns
+	formats.resize(col_count);
+	for (idx_t col_idx = 0; col_idx < col_count; col_idx++) {
+		const auto cast_idx = cast_columns[col_idx];
+		auto &vec = cast_idx == DConstants::INVALID_INDEX ? input.data[col_idx] : cast_chunk.data[cast_idx];
+		vec.ToUnifiedFormat(row_count, formats[col_idx]);
+	}
+
+	// Now write the rows as xml
+	for (idx_t in_idx = 0; in_idx < row_count; in_idx++) {
+		rows.BeginRow();
+
+		for (idx_t col_idx = 0; col_idx < col_count; col_idx++) {
+			const auto &format = formats[col_idx];
+			const auto row_idx = format.sel->get_index(in_idx);
+			if (!format.validity.RowIsValid(row_idx)) {
+				rows.WriteEmptyCell();
+				continue;
+			}
+			cell_writers[col_idx](*this, col_idx, format, row_idx, rows);
+		}
+		rows.EndRow();
+	}
+}
+
 //------------------------------------------------------------------------------
 // Init Global
 //------------------------------------------------------------------------------
 struct GlobalWriteXLSXData final : public GlobalFunctionData {
 
+	mutex lock;
 	XLXSWriter writer;
-	DataChunk cast_chunk;
-	ExpressionExecutor executor;
 	vector<unique_ptr<Expression>> conversion_expressions;
+	shared_ptr<XLSXSharedStringDecisions> string_decisions;
+	// The number of rows appended so far, not counting the header
+	idx_t row_count = 0;
 
 	GlobalWriteXLSXData(ClientContext &context, const string &file_path, const WriteXLSXData &data)
-	    : writer(context, file_path, data.sheet_row_limit), executor(context) {
+	    : writer(context, file_path, data.sheet_row_limit, data.write_buffer_size),
+	      string_decisions(make_shared_ptr<XLSXSharedStringDecisions>(data.column_types.size())) {
+		writer.SetCompressionLevel(data.compression_level);
 
-		// Initialize the expression executor
+		// Initialize the expressions casting the columns that can't be written natively, these are shared by the
+		// serializers of all threads
 		for (idx_t col_idx = 0; col_idx < data.column_types.size(); col_idx++) {
 			auto &col_type = data.column_types[col_idx];
-			auto expr = make_uniq_base<Expression, BoundReferenceExpression>(col_type, col_idx);
-
-			switch (col_type.id()) {
-			case LogicalTypeId::TIMESTAMP_TZ:
-			case LogicalTypeId::TIMESTAMP_SEC:
-			case LogicalTypeId::TIMESTAMP_MS:
-			case LogicalTypeId::TIMESTAMP_NS:
-				expr = BoundCastExpression::AddCastToType(context, std::move(expr), LogicalType::TIMESTAMP);
-			case LogicalTypeId::TIMESTAMP: // Fall through
-				expr = TimestampConversionExpr(std::move(expr));
-				break;
-			case LogicalTypeId::TIME_TZ:
-				expr = BoundCastExpression::AddCastToType(context, std::move(expr), LogicalType::TIME);
-			case LogicalTypeId::TIME: // Fall through
-				expr = TimeConversionExpr(std::move(expr));
-				break;
-			case LogicalTypeId::DATE:
-				expr = DateConversionExpr(std::move(expr));
-				break;
-			case LogicalTypeId::BOOLEAN:
-				// Convert booleans to numbers first, then number to varchar
-				expr = BoundCastExpression::AddCastToType(context, std::move(expr), LogicalType::INTEGER);
-				break;
-			default:
-				break;
+			if (XLSXChunkSerializer::GetNativeCellWriter(col_type)) {
+				continue;
 			}
-
-			// Finally, cast the column to a VARCHAR
-			expr = BoundCastExpression::AddCastToType(context, std::move(expr), LogicalType::VARCHAR);
-
+			auto expr = make_uniq_base<Expression, BoundReferenceExpression>(col_type, col_idx);
+			expr = BoundCastExpression::AddCastToType(context, std::move(expr),
+			                                          XLSXChunkSerializer::GetCastType(col_type));
 			conversion_expressions.push_back(std::move(expr));
-			executor.AddExpression(*conversion_expressions.back());
 		}
+	}
 
-		// Initialize the cast chunk;
-		const vector<LogicalType> types(data.column_types.size(), LogicalType::VARCHAR);
-		cast_chunk.Initialize(BufferAllocator::Get(context), types);
+	// Append serialized rows to the sheet, after the rows appended so far
+	void AppendRows(const XLSXRowBuffer &rows) {
+		{
+			lock_guard<mutex> guard(lock);
+			writer.AppendRows(rows);
+			row_count += rows.GetRowCount();
+		}
+		// Then help compressing the sheet, without holding up the other threads
+		writer.CompressBlocks();
 	}
 };
 
@@ -225,6 +729,9 @@ static unique_ptr<GlobalFunctionData> InitGlobal(ClientContext &context, Functio
 
 	// Begin writing the worksheet
 	writer.BeginSheet(data.sheet_name, data.column_names, data.column_types);
+	if (data.sheet_rollover) {
+		writer.EnableSheetRollover(data.header);
+	}
 
 	// Write the header
 	if (data.header) {
@@ -240,118 +747,153 @@ static unique_ptr<GlobalFunctionData> InitGlobal(ClientContext &context, Functio
 //------------------------------------------------------------------------------
 // Init Local
 //------------------------------------------------------------------------------
-struct LocalWriteXLSXData final : public LocalFunctionData {};
+struct LocalWriteXLSXData final : public LocalFunctionData {
+	explicit LocalWriteXLSXData(const WriteXLSXData &data) : rows(data.column_types.size()) {
+	}
+
+	// Created on the first sink, as the conversion expressions are part of the global state
+	unique_ptr<XLSXChunkSerializer> serializer;
+	XLSXRowBuffer rows;
+};
 
 static unique_ptr<LocalFunctionData> InitLocal(ExecutionContext &context, FunctionData &bind_data) {
-	return make_uniq<LocalWriteXLSXData>();
+	auto &data = bind_data.Cast<WriteXLSXData>();
+	return make_uniq<LocalWriteXLSXData>(data);
 }
 
 //------------------------------------------------------------------------------
 // Sink
 //------------------------------------------------------------------------------
+// Rows are serialized into the local buffer, which is appended to the
+// sheet once it grows large enough. This is only done in parallel when
+// the insertion order does not have to be preserved, otherwise there
+// is either a single thread or the batch functions below are used.
+//
+// When files are rotated, the rows are appended right away instead,
+// so that the row count of the file is up to date when the next chunk
+// decides whether to continue in a new file.
+//------------------------------------------------------------------------------
+static constexpr idx_t LOCAL_FLUSH_SIZE = 4 * 1024 * 1024;
+
 static void Sink(ExecutionContext &context, FunctionData &bind_data, GlobalFunctionData &gstate,
                  LocalFunctionData &lstate, DataChunk &input) {
 	auto &data = bind_data.Cast<WriteXLSXData>();
 	auto &state = gstate.Cast<GlobalWriteXLSXData>();
-	auto &writer = state.writer;
+	auto &local_state = lstate.Cast<LocalWriteXLSXData>();
 
-	const auto row_count = input.size();
-	const auto col_count = input.data.size();
+	if (!local_state.serializer) {
+		local_state.serializer =
+		    make_uniq<XLSXChunkSerializer>(context.client, data, state.conversion_expressions, state.string_decisions);
+	}
 
-	// First, cast the input columns to the target columns
-	state.executor.Execute(input, state.cast_chunk);
+	local_state.serializer->Serialize(input, local_state.rows);
 
-	// Then, setup unified formats for the cast columns
-	vector<UnifiedVectorFormat> formats;
-	formats.resize(col_count);
+	if (local_state.rows.GetSizeInBytes() >= LOCAL_FLUSH_SIZE || data.rows_per_file.IsValid()) {
+		state.AppendRows(local_state.rows);
+		local_state.rows.Clear();
+	}
+}
 
-	for (idx_t col_idx = 0; col_idx < col_count; col_idx++) {
-		state.cast_chunk.data[col_idx].ToUnifiedFormat(row_count, formats[col_idx]);
+//------------------------------------------------------------------------------
+// Combine
+//------------------------------------------------------------------------------
+static void Combine(ExecutionContext &context, FunctionData &bind_data, GlobalFunctionData &gstate,
+                    LocalFunctionData &lstate) {
+	auto &state = gstate.Cast<GlobalWriteXLSXData>();
+	auto &local_state = lstate.Cast<LocalWriteXLSXData>();
+
+	// Append whatever is left
+	if (local_state.rows.GetRowCount() != 0) {
+		state.AppendRows(local_state.rows);
+		local_state.rows.Clear();
 	}
+}
 
-	// Now write the rows as xml
-	for (idx_t in_idx = 0; in_idx < row_count; in_idx++) {
-		writer.BeginRow();
+//------------------------------------------------------------------------------
+// Batches
+//------------------------------------------------------------------------------
+// When the insertion order has to be preserved, batches of rows are
+// serialized in parallel, and then appended to the sheet in the order
+// of their batch index. The row numbers are only filled in when the
+// batch is appended.
+//------------------------------------------------------------------------------
+struct XLSXWriteBatch final : public PreparedBatchData {
+	explicit XLSXWriteBatch(idx_t column_count) : rows(column_count) {
+	}
+	XLSXRowBuffer rows;
+};
 
-		for (idx_t col_idx = 0; col_idx < col_count; col_idx++) {
-			const auto &format = formats[col_idx];
-			const auto row_idx = format.sel->get_index(in_idx);
-			if (!format.validity.RowIsValid(row_idx)) {
-				writer.WriteEmptyCell();
-				continue;
-			}
+static unique_ptr<PreparedBatchData> PrepareBatch(ClientContext &context, FunctionData &bind_data,
+                                                  GlobalFunctionData &gstate,
+                                                  unique_ptr<ColumnDataCollection> collection) {
+	auto &data = bind_data.Cast<WriteXLSXData>();
+	auto &state = gstate.Cast<GlobalWriteXLSXData>();
 
-			const auto &val = UnifiedVectorFormat::GetData<string_t>(format)[row_idx];
-			const auto &type = data.column_types[col_idx];
-
-			switch (type.id()) {
-			case LogicalTypeId::BOOLEAN:
-				writer.WriteBooleanCell(val);
-				break;
-			case LogicalTypeId::DATE:
-				writer.WriteDateCell(val);
-				break;
-			case LogicalTypeId::TIME_TZ:
-			case LogicalTypeId::TIME:
-				writer.WriteTimeCell(val);
-				break;
-			case LogicalTypeId::TIMESTAMP_TZ:
-			case LogicalTypeId::TIMESTAMP_MS:
-			case LogicalTypeId::TIMESTAMP_NS:
-			case LogicalTypeId::TIMESTAMP:
-				writer.WriteTimestampCell(val);
-				break;
-			case LogicalTypeId::TIMESTAMP_SEC:
-				// Style this differently (no milliseconds)
-				writer.WriteTimestampCellNoMilliseconds(val);
-				break;
-			case LogicalTypeId::TINYINT:
-			case LogicalTypeId::SMALLINT:
-			case LogicalTypeId::INTEGER:
-			case LogicalTypeId::BIGINT:
-			case LogicalTypeId::HUGEINT:
-			case LogicalTypeId::FLOAT:
-			case LogicalTypeId::DOUBLE:
-			case LogicalTypeId::DECIMAL:
-			case LogicalTypeId::UTINYINT:
-			case LogicalTypeId::USMALLINT:
-			case LogicalTypeId::UINTEGER:
-			case LogicalTypeId::UBIGINT:
-			case LogicalTypeId::UHUGEINT:
-				writer.WriteNumberCell(val);
-				break;
-			default:
-				writer.WriteInlineStringCell(val);
-				break;
-			}
-		}
-		writer.EndRow();
+	auto batch = make_uniq<XLSXWriteBatch>(data.column_types.size());
+	// The XML is usually a few times larger than the data itself
+	batch->rows.Reserve(collection->SizeInBytes() * 2);
+	XLSXChunkSerializer serializer(context, data, state.conversion_expressions, state.string_decisions);
+	for (auto &chunk : collection->Chunks()) {
+		serializer.Serialize(chunk, batch->rows);
 	}
+
+	// Batches are appended by one thread at a time, so help compressing the sheet here as well
+	state.writer.CompressBlocks();
+	return std::move(batch);
+}
+
+static void FlushBatch(ClientContext &context, FunctionData &bind_data, GlobalFunctionData &gstate,
+                       PreparedBatchData &batch) {
+	auto &state = gstate.Cast<GlobalWriteXLSXData>();
+	auto &write_batch = batch.Cast<XLSXWriteBatch>();
+	state.AppendRows(write_batch.rows);
+}
+
+static idx_t DesiredBatchSize(ClientContext &context, FunctionData &bind_data) {
+	return STANDARD_VECTOR_SIZE * 32;
 }
 
 //------------------------------------------------------------------------------
-// Combine
+// Rotate
 //------------------------------------------------------------------------------
-static void Combine(ExecutionContext &context, FunctionData &bind_data, GlobalFunctionData &gstate,
-                    LocalFunctionData &lstate) {
+// DuckDB opens a new file (and global state) once the current one is
+// full. Partitioned (PARTITION_BY) and per thread (PER_THREAD_OUTPUT)
+// writes need nothing special, every file simply has its own writer.
+//------------------------------------------------------------------------------
+static bool RotateFiles(FunctionData &bind_data, const optional_idx &file_size_bytes) {
+	auto &data = bind_data.Cast<WriteXLSXData>();
+	return data.rows_per_file.IsValid();
+}
+
+static bool RotateNextFile(GlobalFunctionData &gstate, FunctionData &bind_data, const optional_idx &file_size_bytes) {
+	auto &data = bind_data.Cast<WriteXLSXData>();
+	auto &state = gstate.Cast<GlobalWriteXLSXData>();
+	lock_guard<mutex> guard(state.lock);
+	return data.rows_per_file.IsValid() && state.row_count >= data.rows_per_file.GetIndex();
 }
 
 //------------------------------------------------------------------------------
 // Finalize
 //------------------------------------------------------------------------------
 static void Finalize(ClientContext &context, FunctionData &bind_data, GlobalFunctionData &gstate) {
+	auto &data = bind_data.Cast<WriteXLSXData>();
 	auto &state = gstate.Cast<GlobalWriteXLSXData>();
 
 	// Finish writing the worksheet
 	state.writer.EndSheet();
-	state.writer.Finish();
+	state.writer.Finish(data.sync);
 }
 
 //------------------------------------------------------------------------------
 // Execution Mode
 //------------------------------------------------------------------------------
 CopyFunctionExecutionMode ExecutionMode(bool preserve_insertion_order, bool supports_batch_index) {
-	// TODO: Support parallel ordered batch writes
+	if (!preserve_insertion_order) {
+		return CopyFunctionExecutionMode::PARALLEL_COPY_TO_FILE;
+	}
+	if (supports_batch_index) {
+		return CopyFunctionExecutionMode::BATCH_COPY_TO_FILE;
+	}
 	return CopyFunctionExecutionMode::REGULAR_COPY_TO_FILE;
 }
 
@@ -478,6 +1020,11 @@ void WriteXLSX::Register(DatabaseInstance &db) {
 	info.copy_to_combine = Combine;
 	info.copy_to_finalize = Finalize;
 	info.execution_mode = ExecutionMode;
+	info.prepare_batch = PrepareBatch;
+	info.flush_batch = FlushBatch;
+	info.desired_batch_size = DesiredBatchSize;
+	info.rotate_files = RotateFiles;
+	info.rotate_next_file = RotateNextFile;
 
 	info.copy_from_bind = CopyFromBind;
 	info.copy_from_function = ReadXLSX::GetFunction();
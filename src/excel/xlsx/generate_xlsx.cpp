@@ -0,0 +1,270 @@
+#include "xlsx/read_xlsx.hpp"
+#include "xlsx/xlsx_writer.hpp"
+
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/main/extension_util.hpp"
+
+namespace duckdb {
+
+//-------------------------------------------------------------------
+// Generate
+//-------------------------------------------------------------------
+// xlsx_generate writes a synthetic workbook of a given shape, for
+// benchmarking and testing at scale without checking in huge files.
+//
+// Every cell is derived from a hash of (seed, row, column) only, so
+// the same arguments always produce the same workbook. Columns are
+// assigned a kind (number, date or string) using a low discrepancy
+// sequence so that the ratios hold even for a handful of columns.
+//-------------------------------------------------------------------
+
+enum class GeneratedColumnKind : uint8_t { NUMBER, DATE, STRING };
+
+struct GenerateXLSXData final : public TableFunctionData {
+	string file_path;
+	idx_t row_count = 0;
+	idx_t col_count = 0;
+	double string_ratio = 0.0;
+	double date_ratio = 0.0;
+	double sparsity = 0.0;
+	bool shared_strings = false;
+	bool header = true;
+	uint64_t seed = 0;
+	// Strings are drawn from a vocabulary of this size, so that shared strings actually get reused
+	idx_t string_cardinality = 10000;
+};
+
+static double GetRatio(const named_parameter_map_t &params, const char *name) {
+	const auto entry = params.find(name);
+	if (entry == params.end()) {
+		return 0.0;
+	}
+	const auto value = DoubleValue::Get(entry->second);
+	if (value < 0.0 || value > 1.0) {
+		throw BinderException("xlsx_generate: '%s' must be between 0 and 1", name);
+	}
+	return value;
+}
+
+static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
+                                     vector<LogicalType> &return_types, vector<string> &names) {
+	auto result = make_uniq<GenerateXLSXData>();
+
+	for (auto &input_val : input.inputs) {
+		if (input_val.IsNull()) {
+			throw BinderException("xlsx_generate: arguments can not be NULL");
+		}
+	}
+	result->file_path = StringValue::Get(input.inputs[0]);
+
+	const auto rows = BigIntValue::Get(input.inputs[1]);
+	const auto cols = BigIntValue::Get(input.inputs[2]);
+	if (rows < 0) {
+		throw BinderException("xlsx_generate: the number of rows can not be negative");
+	}
+	if (cols <= 0 || cols > static_cast<int64_t>(XLSX_MAX_CELL_COLS)) {
+		throw BinderException("xlsx_generate: the number of columns must be between 1 and %d", XLSX_MAX_CELL_COLS);
+	}
+	result->row_count = static_cast<idx_t>(rows);
+	result->col_count = static_cast<idx_t>(cols);
+
+	auto &params = input.named_parameters;
+	result->string_ratio = GetRatio(params, "string_ratio");
+	result->date_ratio = GetRatio(params, "date_ratio");
+	result->sparsity = GetRatio(params, "sparsity");
+	if (result->string_ratio + result->date_ratio > 1.0) {
+		throw BinderException("xlsx_generate: 'string_ratio' and 'date_ratio' can not add up to more than 1");
+	}
+
+	const auto shared_strings_opt = params.find("shared_strings");
+	if (shared_strings_opt != params.end()) {
+		result->shared_strings = BooleanValue::Get(shared_strings_opt->second);
+	}
+	const auto header_opt = params.find("header");
+	if (header_opt != params.end()) {
+		result->header = BooleanValue::Get(header_opt->second);
+	}
+	const auto seed_opt = params.find("seed");
+	if (seed_opt != params.end()) {
+		result->seed = static_cast<uint64_t>(BigIntValue::Get(seed_opt->second));
+	}
+	const auto string_cardinality_opt = params.find("string_cardinality");
+	if (string_cardinality_opt != params.end()) {
+		const auto string_cardinality = BigIntValue::Get(string_cardinality_opt->second);
+		if (string_cardinality <= 0) {
+			throw BinderException("xlsx_generate: 'string_cardinality' must be positive");
+		}
+		result->string_cardinality = static_cast<idx_t>(string_cardinality);
+	}
+
+	names = {"path", "rows", "columns", "cells"};
+	return_types = {LogicalType::VARCHAR, LogicalType::BIGINT, LogicalType::BIGINT, LogicalType::BIGINT};
+
+	return std::move(result);
+}
+
+//-------------------------------------------------------------------
+// Global State
+//-------------------------------------------------------------------
+struct GenerateXLSXState final : public GlobalTableFunctionState {
+	bool finished = false;
+};
+
+static unique_ptr<GlobalTableFunctionState> InitGlobal(ClientContext &context, TableFunctionInitInput &input) {
+	return make_uniq<GenerateXLSXState>();
+}
+
+//-------------------------------------------------------------------
+// Execute
+//-------------------------------------------------------------------
+
+// The splitmix64 finalizer. We dont use duckdb's Hash here so that the output stays the same across versions
+static uint64_t MixBits(uint64_t x) {
+	x += 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+static GeneratedColumnKind GetColumnKind(const GenerateXLSXData &data, const idx_t col_idx) {
+	static constexpr auto GOLDEN_RATIO_FRACTION = 0.6180339887498949;
+	const auto pos = std::fmod(static_cast<double>(col_idx + 1) * GOLDEN_RATIO_FRACTION, 1.0);
+	if (pos < data.string_ratio) {
+		return GeneratedColumnKind::STRING;
+	}
+	if (pos < data.string_ratio + data.date_ratio) {
+		return GeneratedColumnKind::DATE;
+	}
+	return GeneratedColumnKind::NUMBER;
+}
+
+static idx_t GenerateWorkbook(ClientContext &context, const GenerateXLSXData &data) {
+	// Excel serial number of 2000-01-01, generated dates are spread over the ~27 years after it
+	static constexpr auto SERIAL_2000_01_01 = 36526ULL;
+
+	// Allow generating sheets that are larger than what excel supports, that is kind of the point
+	const auto sheet_row_limit = MaxValue<idx_t>(XLSX_MAX_CELL_ROWS, data.row_count + 1);
+	XLXSWriter writer(context, data.file_path, sheet_row_limit);
+
+	vector<string> column_names;
+	vector<LogicalType> column_types;
+	vector<GeneratedColumnKind> column_kinds;
+	for (idx_t col_idx = 0; col_idx < data.col_count; col_idx++) {
+		const auto kind = GetColumnKind(data, col_idx);
+		column_kinds.push_back(kind);
+		column_names.push_back("col" + std::to_string(col_idx + 1));
+		switch (kind) {
+		case GeneratedColumnKind::STRING:
+			column_types.push_back(LogicalType::VARCHAR);
+			break;
+		case GeneratedColumnKind::DATE:
+			column_types.push_back(LogicalType::DATE);
+			break;
+		default:
+			column_types.push_back(LogicalType::DOUBLE);
+			break;
+		}
+	}
+
+	writer.BeginSheet("Sheet1", column_names, column_types);
+
+	if (data.header) {
+		writer.BeginRow();
+		for (const auto &name : column_names) {
+			if (data.shared_strings) {
+				writer.WriteSharedStringCell(string_t(name));
+			} else {
+				writer.WriteInlineStringCell(string_t(name));
+			}
+		}
+		writer.EndRow();
+	}
+
+	const auto seed = MixBits(data.seed);
+	char buffer[64];
+	idx_t cell_count = 0;
+
+	for (idx_t row_idx = 0; row_idx < data.row_count; row_idx++) {
+		writer.BeginRow();
+		for (idx_t col_idx = 0; col_idx < data.col_count; col_idx++) {
+			const auto hash = MixBits(seed ^ (row_idx * data.col_count + col_idx));
+
+			// Use the upper 53 bits for the sparsity check, and the lower bits for the value
+			const auto draw = static_cast<double>(hash >> 11) / static_cast<double>(1ULL << 53);
+			if (draw < data.sparsity) {
+				writer.WriteEmptyCell();
+				continue;
+			}
+			cell_count++;
+
+			switch (column_kinds[col_idx]) {
+			case GeneratedColumnKind::NUMBER: {
+				const auto value = hash % 10000000ULL;
+				const auto len = snprintf(buffer, sizeof(buffer), "%llu.%02llu",
+				                          static_cast<unsigned long long>(value / 100),
+				                          static_cast<unsigned long long>(value % 100));
+				writer.WriteNumberCell(string_t(buffer, UnsafeNumericCast<uint32_t>(len)));
+			} break;
+			case GeneratedColumnKind::DATE: {
+				const auto value = SERIAL_2000_01_01 + hash % 10000ULL;
+				const auto len = snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(value));
+				writer.WriteDateCell(string_t(buffer, UnsafeNumericCast<uint32_t>(len)));
+			} break;
+			case GeneratedColumnKind::STRING: {
+				const auto value = hash % data.string_cardinality;
+				const auto len =
+				    snprintf(buffer, sizeof(buffer), "value_%llu", static_cast<unsigned long long>(value));
+				const string_t str(buffer, UnsafeNumericCast<uint32_t>(len));
+				if (data.shared_strings) {
+					writer.WriteSharedStringCell(str);
+				} else {
+					writer.WriteInlineStringCell(str);
+				}
+			} break;
+			}
+		}
+		writer.EndRow();
+	}
+
+	writer.EndSheet();
+	writer.Finish();
+
+	return cell_count;
+}
+
+static void Execute(ClientContext &context, TableFunctionInput &input, DataChunk &output) {
+	auto &data = input.bind_data->Cast<GenerateXLSXData>();
+	auto &state = input.global_state->Cast<GenerateXLSXState>();
+	if (state.finished) {
+		return;
+	}
+	state.finished = true;
+
+	const auto cell_count = GenerateWorkbook(context, data);
+
+	output.SetValue(0, 0, Value(data.file_path));
+	output.SetValue(1, 0, Value::BIGINT(NumericCast<int64_t>(data.row_count)));
+	output.SetValue(2, 0, Value::BIGINT(NumericCast<int64_t>(data.col_count)));
+	output.SetValue(3, 0, Value::BIGINT(NumericCast<int64_t>(cell_count)));
+	output.SetCardinality(1);
+}
+
+//-------------------------------------------------------------------
+// Register
+//-------------------------------------------------------------------
+void GenerateXLSX::Register(DatabaseInstance &db) {
+	TableFunction generate("xlsx_generate", {LogicalType::VARCHAR, LogicalType::BIGINT, LogicalType::BIGINT},
+	                       Execute, Bind, InitGlobal);
+
+	generate.named_parameters["string_ratio"] = LogicalType::DOUBLE;
+	generate.named_parameters["date_ratio"] = LogicalType::DOUBLE;
+	generate.named_parameters["sparsity"] = LogicalType::DOUBLE;
+	generate.named_parameters["shared_strings"] = LogicalType::BOOLEAN;
+	generate.named_parameters["header"] = LogicalType::BOOLEAN;
+	generate.named_parameters["seed"] = LogicalType::BIGINT;
+	generate.named_parameters["string_cardinality"] = LogicalType::BIGINT;
+
+	ExtensionUtil::RegisterFunction(db, generate);
+}
+
+} // namespace duckdb
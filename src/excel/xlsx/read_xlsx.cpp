@@ -9,9 +9,11 @@
 #include "xlsx/parsers/content_types_parser.hpp"
 #include "xlsx/parsers/stylesheet_parser.hpp"
 #include "xlsx/parsers/shared_strings_parser.hpp"
+#include "xlsx/parsers/table_parser.hpp"
 #include "xlsx/parsers/workbook_parser.hpp"
 #include "xlsx/parsers/worksheet_parser.hpp"
 
+#include "duckdb/common/file_system.hpp"
 #include "duckdb/common/types/time.hpp"
 #include "duckdb/function/table_function.hpp"
 #include "duckdb/main/database.hpp"
@@ -21,17 +23,24 @@
 #include "duckdb/parser/tableref/table_function_ref.hpp"
 #include "duckdb/main/query_result.hpp"
 #include "duckdb/common/helper.hpp"
+#include "duckdb/common/profiler.hpp"
+#include "duckdb/common/unordered_set.hpp"
 #include "duckdb/function/replacement_scan.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+#include "duckdb/storage/temporary_memory_manager.hpp"
 
 namespace duckdb {
 
 //-------------------------------------------------------------------
 // Meta
 //-------------------------------------------------------------------
-static void ParseXLSXFileMeta(const unique_ptr<XLSXReadData> &result, ZipFileReader &reader) {
+static vector<string> SelectTable(const unique_ptr<XLSXReadData> &result, ZipFileReader &reader,
+                                  const vector<pair<string, string>> &sheets, const vector<XLSXRelation> &wbrels);
+static void SelectDefinedName(const unique_ptr<XLSXReadData> &result, ZipFileReader &reader,
+                              const vector<pair<string, string>> &sheets, const vector<XLSXRelation> &wbrels);
 
-	unordered_map<string, string> candidate_sheets;
-	string primary_sheet;
+// Returns the column names of the table, if a table is read
+static vector<string> ParseXLSXFileMeta(const unique_ptr<XLSXReadData> &result, ZipFileReader &reader) {
 
 	// Extract the content types to get the primary sheet
 	if (!reader.TryOpenEntry("[Content_Types].xml")) {
@@ -54,6 +63,21 @@ static void ParseXLSXFileMeta(const unique_ptr<XLSXReadData> &result, ZipFileRea
 
 	// TODO: Detect if we have a shared string table
 
+	if (!result->options.table_name.empty()) {
+		return SelectTable(result, reader, sheets, wbrels);
+	}
+	if (!result->options.defined_name.empty()) {
+		SelectDefinedName(result, reader, sheets, wbrels);
+		return {};
+	}
+	ReadXLSX::SelectSheet(result, sheets, wbrels);
+	return {};
+}
+
+vector<pair<string, string>> ReadXLSX::GetSheetPaths(const vector<pair<string, string>> &sheets,
+                                                     const vector<XLSXRelation> &wbrels) {
+	vector<pair<string, string>> result;
+
 	// Resolve the sheet names to the paths
 	// Start by mapping rid to sheet path
 	unordered_map<string, string> rid_to_sheet_map;
@@ -67,18 +91,27 @@ static void ParseXLSXFileMeta(const unique_ptr<XLSXReadData> &result, ZipFileRea
 	for (auto &sheet : sheets) {
 		const auto found = rid_to_sheet_map.find(sheet.second);
 		if (found != rid_to_sheet_map.end()) {
-
 			// Normalize everything to absolute paths
 			if (StringUtil::StartsWith(found->second, "/xl/")) {
-				candidate_sheets[sheet.first] = found->second.substr(1);
+				result.emplace_back(sheet.first, found->second.substr(1));
 			} else {
-				candidate_sheets[sheet.first] = "xl/" + found->second;
+				result.emplace_back(sheet.first, "xl/" + found->second);
 			}
+		}
+	}
+	return result;
+}
 
-			// Set the first sheet we find as the primary sheet
-			if (primary_sheet.empty()) {
-				primary_sheet = sheet.first;
-			}
+void ReadXLSX::SelectSheet(const unique_ptr<XLSXReadData> &result, const vector<pair<string, string>> &sheets,
+                           const vector<XLSXRelation> &wbrels) {
+	unordered_map<string, string> candidate_sheets;
+	string primary_sheet;
+
+	for (auto &sheet : GetSheetPaths(sheets, wbrels)) {
+		candidate_sheets[sheet.first] = sheet.second;
+		// Set the first sheet we find as the primary sheet
+		if (primary_sheet.empty()) {
+			primary_sheet = sheet.first;
 		}
 	}
 
@@ -106,7 +139,279 @@ static void ParseXLSXFileMeta(const unique_ptr<XLSXReadData> &result, ZipFileRea
 	result->sheet_path = found->second;
 }
 
-static void ResolveColumnNames(vector<XLSXCell> &header_cells, ZipFileReader &archive) {
+//-------------------------------------------------------------------
+// Tables and Defined Names
+//-------------------------------------------------------------------
+// Both resolve to a sheet and an exact range at bind time, which is
+// then read just like an explicit "range" option.
+//
+// Tables are linked from the relations of the sheet they are on, and
+// their range includes the header and totals rows, which we exclude.
+// Defined names are stored as formulas in the workbook, of which we
+// only support plain references to a single range.
+//-------------------------------------------------------------------
+
+// Resolve a relation target relative to the directory of the part it belongs to
+static string ResolveRelationTarget(const string &part_path, const string &target) {
+	if (StringUtil::StartsWith(target, "/")) {
+		return target.substr(1);
+	}
+	auto parts = StringUtil::Split(part_path, '/');
+	// Remove the file name of the part itself
+	parts.pop_back();
+	for (auto &part : StringUtil::Split(target, '/')) {
+		if (part == "..") {
+			if (!parts.empty()) {
+				parts.pop_back();
+			}
+		} else if (part != ".") {
+			parts.push_back(part);
+		}
+	}
+	return StringUtil::Join(parts, "/");
+}
+
+static vector<string> SelectTable(const unique_ptr<XLSXReadData> &result, ZipFileReader &reader,
+                                  const vector<pair<string, string>> &sheets, const vector<XLSXRelation> &wbrels) {
+	auto &options = result->options;
+	vector<string> all_tables;
+
+	for (auto &sheet : ReadXLSX::GetSheetPaths(sheets, wbrels)) {
+		// The tables on a sheet are listed in the relations of the sheet, e.g. "xl/worksheets/_rels/sheet1.xml.rels"
+		const auto &sheet_path = sheet.second;
+		const auto sep = sheet_path.rfind('/');
+		const auto sheet_dir = sep == string::npos ? string() : sheet_path.substr(0, sep + 1);
+		const auto sheet_file = sep == string::npos ? sheet_path : sheet_path.substr(sep + 1);
+		if (!reader.TryOpenEntry(sheet_dir + "_rels/" + sheet_file + ".rels")) {
+			continue;
+		}
+		const auto sheet_rels = RelParser::ParseRelations(reader);
+		reader.CloseEntry();
+
+		for (auto &rel : sheet_rels) {
+			if (!StringUtil::EndsWith(rel.type, "/table")) {
+				continue;
+			}
+			const auto table_path = ResolveRelationTarget(sheet_path, rel.target);
+			if (!reader.TryOpenEntry(table_path)) {
+				throw BinderException("Table '%s' not found in xlsx file", table_path);
+			}
+			auto table = TableParser::ParseTable(reader);
+			reader.CloseEntry();
+
+			// Excel treats table names case-insensitively
+			if (!StringUtil::CIEquals(table.display_name, options.table_name) &&
+			    !StringUtil::CIEquals(table.name, options.table_name)) {
+				all_tables.push_back(table.display_name);
+				continue;
+			}
+
+			XLSXCellRange range;
+			if (!range.TryParse(table.ref.c_str()) || !range.IsValid()) {
+				throw BinderException("Table \"%s\" has an invalid range '%s'", options.table_name, table.ref);
+			}
+			if (table.columns.size() != range.Width() + 1) {
+				throw BinderException("Table \"%s\" has %d columns, but its range '%s' spans %d columns",
+				                      options.table_name, table.columns.size(), table.ref, range.Width() + 1);
+			}
+
+			// Only read the data rows, and make the end exclusive
+			range.beg.row += table.header_row_count;
+			range.end.row = range.end.row + 1 - MinValue(table.totals_row_count, range.end.row);
+			range.end.row = MaxValue(range.end.row, range.beg.row);
+			range.end.col++;
+
+			options.sheet = sheet.first;
+			options.range = range;
+			// The column names are taken from the table definition instead
+			options.header_mode = XLSXHeaderMode::NEVER;
+			result->sheet_path = sheet_path;
+			return std::move(table.columns);
+		}
+	}
+
+	auto suggestions = StringUtil::CandidatesErrorMessage(all_tables, options.table_name, "Did you mean");
+	throw BinderException("Table \"%s\" not found in xlsx file \"%s\"%s", options.table_name, result->file_path,
+	                      suggestions);
+}
+
+// Parse a defined name formula referring to a single range, e.g. "'My Sheet'!$A$1:$C$10" or "Sheet1!$B$2"
+static bool TryParseNameReference(const string &formula, string &sheet, XLSXCellRange &range) {
+	idx_t pos = 0;
+	sheet.clear();
+	if (!formula.empty() && formula[0] == '\'') {
+		// Quoted sheet name, quotes are escaped by doubling them
+		for (pos = 1; pos < formula.size(); pos++) {
+			if (formula[pos] == '\'') {
+				if (pos + 1 < formula.size() && formula[pos + 1] == '\'') {
+					sheet += '\'';
+					pos++;
+				} else {
+					break;
+				}
+			} else {
+				sheet += formula[pos];
+			}
+		}
+		// Skip the closing quote
+		pos++;
+	} else {
+		const auto sep = formula.find('!');
+		if (sep == string::npos) {
+			return false;
+		}
+		sheet = formula.substr(0, sep);
+		pos = sep;
+	}
+	if (sheet.empty() || pos >= formula.size() || formula[pos] != '!') {
+		return false;
+	}
+
+	// Strip the absolute reference markers
+	string ref;
+	for (pos++; pos < formula.size(); pos++) {
+		if (formula[pos] != '$') {
+			ref += formula[pos];
+		}
+	}
+
+	// Either a range, or a single cell
+	auto end = range.TryParse(ref.c_str());
+	if (!end) {
+		XLSXCellPos cell;
+		end = cell.TryParse(ref.c_str());
+		if (!end || cell.row == 0 || cell.col == 0) {
+			return false;
+		}
+		range = XLSXCellRange(cell.row, cell.col, cell.row, cell.col);
+	}
+	return *end == '\0' && range.beg.row != 0 && range.beg.col != 0 && range.IsValid();
+}
+
+// The name of the sheet a defined name is scoped to
+static string GetNameScope(const XLSXDefinedName &defined_name, const vector<pair<string, string>> &sheets) {
+	const auto sheet_id = defined_name.local_sheet_id.GetIndex();
+	if (sheet_id >= sheets.size()) {
+		throw BinderException("Defined name \"%s\" is scoped to sheet %d, which does not exist (is the file corrupt?)",
+		                      defined_name.name, sheet_id);
+	}
+	return sheets[sheet_id].first;
+}
+
+// Names are either scoped to the workbook, or to a single sheet, in which case the same name can be defined once per
+// sheet. Like in Excel, a name scoped to the given sheet takes precedence over the one scoped to the workbook.
+// Without a sheet, we use the one scoped to the workbook, or the one scoped to a sheet if there is only one.
+static const XLSXDefinedName &FindDefinedName(const XLSXReadData &result,
+                                              const vector<XLSXDefinedName> &defined_names,
+                                              const vector<pair<string, string>> &sheets) {
+	auto &options = result.options;
+
+	vector<string> all_names;
+	optional_ptr<const XLSXDefinedName> workbook_name;
+	vector<reference<const XLSXDefinedName>> sheet_names;
+	for (auto &defined_name : defined_names) {
+		// Excel treats defined names case-insensitively
+		if (!StringUtil::CIEquals(defined_name.name, options.defined_name)) {
+			all_names.push_back(defined_name.name);
+		} else if (defined_name.local_sheet_id.IsValid()) {
+			sheet_names.push_back(defined_name);
+		} else {
+			workbook_name = &defined_name;
+		}
+	}
+
+	if (!options.sheet.empty()) {
+		for (auto &sheet_name : sheet_names) {
+			if (StringUtil::CIEquals(GetNameScope(sheet_name, sheets), options.sheet)) {
+				return sheet_name;
+			}
+		}
+		if (!workbook_name && !sheet_names.empty()) {
+			throw BinderException("Defined name \"%s\" is not defined for sheet \"%s\" in xlsx file \"%s\"",
+			                      options.defined_name, options.sheet, result.file_path);
+		}
+	}
+	if (workbook_name) {
+		return *workbook_name;
+	}
+	if (sheet_names.size() == 1) {
+		return sheet_names[0];
+	}
+	if (sheet_names.size() > 1) {
+		vector<string> scopes;
+		for (auto &sheet_name : sheet_names) {
+			scopes.push_back("\"" + GetNameScope(sheet_name, sheets) + "\"");
+		}
+		throw BinderException("Defined name \"%s\" is defined for the sheets %s in xlsx file \"%s\", use the 'sheet' "
+		                      "option to pick one",
+		                      options.defined_name, StringUtil::Join(scopes, ", "), result.file_path);
+	}
+
+	auto suggestions = StringUtil::CandidatesErrorMessage(all_names, options.defined_name, "Did you mean");
+	throw BinderException("Defined name \"%s\" not found in xlsx file \"%s\"%s", options.defined_name,
+	                      result.file_path, suggestions);
+}
+
+static void SelectDefinedName(const unique_ptr<XLSXReadData> &result, ZipFileReader &reader,
+                              const vector<pair<string, string>> &sheets, const vector<XLSXRelation> &wbrels) {
+	auto &options = result->options;
+
+	if (!reader.TryOpenEntry("xl/workbook.xml")) {
+		throw BinderException("No xl/workbook.xml found in xlsx file");
+	}
+	const auto defined_names = WorkBookParser::GetDefinedNames(reader);
+	reader.CloseEntry();
+
+	auto &defined_name = FindDefinedName(*result, defined_names, sheets);
+
+	string sheet_name;
+	XLSXCellRange range;
+	if (!TryParseNameReference(defined_name.formula, sheet_name, range)) {
+		throw BinderException("Defined name \"%s\" does not refer to a single range of cells, but to '%s'",
+		                      options.defined_name, defined_name.formula);
+	}
+	if (range.Width() + 1 > XLSX_MAX_CELL_COLS) {
+		throw BinderException("Defined name \"%s\" refers to an invalid range '%s'", options.defined_name,
+		                      defined_name.formula);
+	}
+
+	for (auto &sheet : ReadXLSX::GetSheetPaths(sheets, wbrels)) {
+		// Like the names themselves, sheet names are case-insensitive
+		if (StringUtil::CIEquals(sheet.first, sheet_name)) {
+			// Make sure the range is inclusive of the last cell
+			range.end.col++;
+			range.end.row++;
+
+			options.sheet = sheet.first;
+			options.range = range;
+			result->sheet_path = sheet.second;
+			return;
+		}
+	}
+	throw BinderException("Sheet \"%s\" referred to by defined name \"%s\" not found in xlsx file \"%s\"",
+	                      sheet_name, options.defined_name, result->file_path);
+}
+
+static void ReadXLSXSheet(ZipFileReader &archive, SheetParserBase &parser) {
+	parser.ParseAll(archive);
+}
+
+static unordered_map<idx_t, string> SearchXLSXStrings(ZipFileReader &archive, const vector<idx_t> &ids) {
+	SharedStringSearcher searcher(ids);
+	searcher.ParseAll(archive);
+	return searcher.GetResult();
+}
+
+const XLSXWorkbookFormat ReadXLSX::XLSX_FORMAT = {"xlsx",
+                                                  "xl/workbook.xml",
+                                                  "xl/_rels/workbook.xml.rels",
+                                                  "xl/sharedStrings.xml",
+                                                  WorkBookParser::GetSheets,
+                                                  ReadXLSXSheet,
+                                                  SearchXLSXStrings};
+
+static void ResolveColumnNames(vector<XLSXCell> &header_cells, ZipFileReader &archive,
+                               const XLSXWorkbookFormat &format) {
 
 	vector<idx_t> shared_string_ids;
 	vector<idx_t> shared_string_pos;
@@ -114,7 +419,7 @@ static void ResolveColumnNames(vector<XLSXCell> &header_cells, ZipFileReader &ar
 	for (idx_t i = 0; i < header_cells.size(); i++) {
 		auto &cell = header_cells[i];
 		if (cell.type == XLSXCellType::SHARED_STRING) {
-			shared_string_ids.push_back(std::strtol(cell.data.c_str(), nullptr, 10));
+			shared_string_ids.push_back(std::strtoull(cell.data.c_str(), nullptr, 10));
 			shared_string_pos.push_back(i);
 		}
 	}
@@ -125,19 +430,30 @@ static void ResolveColumnNames(vector<XLSXCell> &header_cells, ZipFileReader &ar
 	}
 
 	// Resolve the shared strings
-	if (!archive.TryOpenEntry("xl/sharedStrings.xml")) {
-		throw BinderException("No shared strings found in xlsx file");
+	if (!archive.TryOpenEntry(format.shared_strings_path)) {
+		throw BinderException("No shared strings found in %s file", format.name);
 	}
-	SharedStringSearcher searcher(shared_string_ids);
-	searcher.ParseAll(archive);
+	const auto shared_strings = format.search_strings(archive, shared_string_ids);
 	archive.CloseEntry();
 
-	auto &shared_strings = searcher.GetResult();
-
 	// Replace the shared strings with the resolved strings
 	for (idx_t i = 0; i < shared_string_pos.size(); i++) {
-		header_cells[shared_string_pos[i]].data = shared_strings.at(shared_string_ids[i]);
+		const auto found = shared_strings.find(shared_string_ids[i]);
+		if (found == shared_strings.end()) {
+			throw InvalidInputException("Shared string index '%d' out of range in %s file (is the file corrupted?)",
+			                            shared_string_ids[i], format.name);
+		}
+		header_cells[shared_string_pos[i]].data = found->second;
+	}
+}
+
+static LogicalType ParseColumnType(const string &type_str) {
+	const auto type = TransformStringToLogicalType(type_str);
+	if (type.id() == LogicalTypeId::USER) {
+		throw BinderException("Unsupported column type '%s', only built-in types can be read from xlsx files",
+		                      type_str);
 	}
+	return type;
 }
 
 void ReadXLSX::ParseOptions(XLSXReadOptions &options, const named_parameter_map_t &input) {
@@ -145,8 +461,8 @@ void ReadXLSX::ParseOptions(XLSXReadOptions &options, const named_parameter_map_
 	// Check which sheet to use, default to the primary sheet
 	const auto sheet_opt = input.find("sheet");
 	if (sheet_opt != input.end()) {
-		// We need to escape all user-supplied strings when searching for them in the XML
-		options.sheet = EscapeXMLString(StringValue::Get(sheet_opt->second));
+		// The sheet names are unescaped by the XML parser, so match against the name as given
+		options.sheet = StringValue::Get(sheet_opt->second);
 	}
 
 	// Get the header mode
@@ -192,6 +508,73 @@ void ReadXLSX::ParseOptions(XLSXReadOptions &options, const named_parameter_map_
 		options.stop_at_empty = false;
 	}
 
+	// Tables and defined names are resolved to a sheet and range when binding
+	const auto table_opt = input.find("table");
+	if (table_opt != input.end()) {
+		options.table_name = StringValue::Get(table_opt->second);
+		if (options.table_name.empty()) {
+			throw BinderException("Table name can not be empty");
+		}
+	}
+	const auto name_opt = input.find("name");
+	if (name_opt != input.end()) {
+		options.defined_name = StringValue::Get(name_opt->second);
+		if (options.defined_name.empty()) {
+			throw BinderException("Defined name can not be empty");
+		}
+	}
+	if (!options.table_name.empty() || !options.defined_name.empty()) {
+		const auto option_name = options.table_name.empty() ? "name" : "table";
+		if (!options.table_name.empty() && !options.defined_name.empty()) {
+			throw BinderException("The 'table' and 'name' options can not be combined");
+		}
+		if (!options.table_name.empty() && (sheet_opt != input.end() || range_opt != input.end())) {
+			throw BinderException("The '%s' option can not be combined with the 'sheet' or 'range' options",
+			                      option_name);
+		}
+		// A sheet can be given with a defined name, to pick the one scoped to that sheet
+		if (range_opt != input.end()) {
+			throw BinderException("The '%s' option can not be combined with the 'range' option", option_name);
+		}
+		options.has_explicit_range = true;
+		options.stop_at_empty = false;
+	}
+
+	// Explicit column types, either by name (which also renames the columns) or by position
+	const auto columns_opt = input.find("columns");
+	const auto types_opt = input.find("types");
+	if (columns_opt != input.end() && types_opt != input.end()) {
+		throw BinderException("The 'columns' and 'types' options can not be combined");
+	}
+	if (columns_opt != input.end()) {
+		auto &columns_val = columns_opt->second;
+		if (columns_val.type().id() != LogicalTypeId::STRUCT) {
+			throw BinderException("The 'columns' option requires a struct of column names and types, e.g. "
+			                      "columns = {'a': 'BIGINT', 'b': 'VARCHAR'}");
+		}
+		auto &children = StructValue::GetChildren(columns_val);
+		for (idx_t i = 0; i < children.size(); i++) {
+			if (children[i].IsNull() || children[i].type().id() != LogicalTypeId::VARCHAR) {
+				throw BinderException("The type of column '%s' in the 'columns' option must be a VARCHAR",
+				                      StructType::GetChildName(columns_val.type(), i));
+			}
+			options.column_names.push_back(StructType::GetChildName(columns_val.type(), i));
+			options.column_types.push_back(ParseColumnType(StringValue::Get(children[i])));
+		}
+	}
+	if (types_opt != input.end()) {
+		for (auto &child : ListValue::GetChildren(types_opt->second)) {
+			if (child.IsNull()) {
+				throw BinderException("The types in the 'types' option can not be NULL");
+			}
+			options.column_types.push_back(ParseColumnType(StringValue::Get(child)));
+		}
+	}
+	if ((columns_opt != input.end() || types_opt != input.end()) && options.column_types.empty()) {
+		throw BinderException("The '%s' option requires at least one column",
+		                      columns_opt != input.end() ? "columns" : "types");
+	}
+
 	const auto stop_at_empty_op = input.find("stop_at_empty");
 	if (stop_at_empty_op != input.end()) {
 		options.stop_at_empty = BooleanValue::Get(stop_at_empty_op->second);
@@ -204,35 +587,34 @@ void ReadXLSX::ParseOptions(XLSXReadOptions &options, const named_parameter_map_
 	}
 }
 
-static void ParseStyleSheet(const unique_ptr<XLSXReadData> &result, ZipFileReader &archive) {
+void ReadXLSX::ParseStyleSheet(XLSXReadData &result, ZipFileReader &archive) {
 	// Parse the styles (so we can handle dates)
 	if (archive.TryOpenEntry("xl/styles.xml")) {
 		XLSXStyleParser style_parser;
 		style_parser.ParseAll(archive);
-		result->style_sheet = XLSXStyleSheet(std::move(style_parser.cell_styles));
+		result.style_sheet = XLSXStyleSheet(std::move(style_parser.cell_styles));
 		archive.CloseEntry();
 	}
 }
 
-static void SniffRange(const unique_ptr<XLSXReadData> &result, ZipFileReader &archive) {
-	if (!archive.TryOpenEntry(result->sheet_path)) {
-		throw BinderException("Sheet '%s' not found in xlsx file", result->sheet_path);
+void ReadXLSX::SniffRange(XLSXReadData &result, ZipFileReader &archive, const XLSXWorkbookFormat &format) {
+	if (!archive.TryOpenEntry(result.sheet_path)) {
+		throw BinderException("Sheet '%s' not found in %s file", result.sheet_path, format.name);
 	}
 	RangeSniffer range_sniffer;
-	range_sniffer.ParseAll(archive);
+	format.read_sheet(archive, range_sniffer);
 	archive.CloseEntry();
-	result->options.range = range_sniffer.GetRange();
+	result.options.range = range_sniffer.GetRange();
 }
 
-static void SniffHeader(const unique_ptr<XLSXReadData> &result, ZipFileReader &archive) {
-	auto &options = result->options;
+void ReadXLSX::SniffHeader(XLSXReadData &result, ZipFileReader &archive, const XLSXWorkbookFormat &format) {
+	auto &options = result.options;
 
-	if (!archive.TryOpenEntry(result->sheet_path)) {
-		throw BinderException("Sheet '%s' not found in xlsx file", result->sheet_path);
+	if (!archive.TryOpenEntry(result.sheet_path)) {
+		throw BinderException("Sheet '%s' not found in %s file", result.sheet_path, format.name);
 	}
-	HeaderSniffer sniffer(result->options.range, result->options.header_mode, result->options.has_explicit_range,
-	                      result->options.default_cell_type);
-	sniffer.ParseAll(archive);
+	HeaderSniffer sniffer(options.range, options.header_mode, options.has_explicit_range, options.default_cell_type);
+	format.read_sheet(archive, sniffer);
 	archive.CloseEntry();
 
 	// This is the range of actual data in the sheet (header not included)
@@ -241,6 +623,16 @@ static void SniffHeader(const unique_ptr<XLSXReadData> &result, ZipFileReader &a
 	auto &header_cells = sniffer.GetHeaderCells();
 	auto &column_cells = sniffer.GetColumnCells();
 
+	ReadXLSX::PadHeader(options, header_cells, column_cells);
+
+	// Resolve any shared strings in the header
+	ResolveColumnNames(header_cells, archive, format);
+
+	ReadXLSX::BindColumns(result, header_cells, column_cells);
+}
+
+void ReadXLSX::PadHeader(const XLSXReadOptions &options, vector<XLSXCell> &header_cells,
+                         vector<XLSXCell> &column_cells) {
 	if (column_cells.empty()) {
 		if (header_cells.empty()) {
 			if (!options.has_explicit_range) {
@@ -249,62 +641,216 @@ static void SniffHeader(const unique_ptr<XLSXReadData> &result, ZipFileReader &a
 			// Otherwise, add a header row with the column names in the range
 			for (idx_t i = options.range.beg.col; i < options.range.end.col; i++) {
 				XLSXCellPos pos(options.range.beg.row, i);
-				header_cells.emplace_back(result->options.default_cell_type, pos, pos.ToString(), 0);
+				header_cells.emplace_back(options.default_cell_type, pos, pos.ToString(), 0);
 			}
 		}
 		// Else, we have a header row but no data rows
 		// Users seem to expect this to work, so we allow it by creating an empty dummy row of varchars
 		for (auto &cell : header_cells) {
-			column_cells.emplace_back(result->options.default_cell_type, cell.cell, "", 0);
+			column_cells.emplace_back(options.default_cell_type, cell.cell, "", 0);
 		}
 	}
+}
 
-	// Resolve any shared strings in the header
-	ResolveColumnNames(header_cells, archive);
+void ReadXLSX::BindColumns(XLSXReadData &result, const vector<XLSXCell> &header_cells,
+                           vector<XLSXCell> &column_cells) {
+	auto &options = result.options;
 
 	// Set the return names
 	for (auto &cell : header_cells) {
-		result->column_names.push_back(cell.data);
+		result.column_names.push_back(cell.data);
+	}
+
+	if (!options.column_types.empty()) {
+		// The types are given, so we don't infer them from the first data row
+		if (options.column_types.size() != column_cells.size()) {
+			vector<string> sheet_columns;
+			for (auto &cell : header_cells) {
+				sheet_columns.push_back(cell.data);
+			}
+			throw BinderException("%d column types were given, but the sheet has %d columns in the range %s:%s (%s)",
+			                      options.column_types.size(), column_cells.size(),
+			                      XLSXCellPos(options.range.beg.row, options.range.beg.col).ToString(),
+			                      XLSXCellPos(options.range.beg.row, options.range.end.col - 1).ToString(),
+			                      StringUtil::Join(sheet_columns, ", "));
+		}
+		if (!options.column_names.empty()) {
+			result.column_names = options.column_names;
+		}
+		for (idx_t col_idx = 0; col_idx < column_cells.size(); col_idx++) {
+			auto &cell = column_cells[col_idx];
+			const auto &type = options.column_types[col_idx];
+			result.return_types.push_back(type);
+
+			// The source type only decides whether numbers are converted from excel serials to temporal types.
+			// Whether a cell holds a number is decided per cell when reading, so don't go by the first row here
+			result.source_types.push_back(IsExcelSerialType(type) ? XLSXCellType::NUMBER : cell.type);
+		}
+		return;
 	}
 
 	// Convert excel types to duckdb types
 	for (auto &cell : column_cells) {
-		auto duckdb_type = cell.GetDuckDBType(result->options.all_varchar, result->style_sheet);
-		result->return_types.push_back(duckdb_type);
-		result->source_types.push_back(cell.type);
+		auto duckdb_type = cell.GetDuckDBType(result.options.all_varchar, result.style_sheet);
+		result.return_types.push_back(duckdb_type);
+		result.source_types.push_back(cell.type);
 	}
 }
 
 void ReadXLSX::ResolveSheet(const unique_ptr<XLSXReadData> &result, ZipFileReader &archive) {
 	// Parse the meta
-	ParseXLSXFileMeta(result, archive);
+	const auto table_columns = ParseXLSXFileMeta(result, archive);
 	// Parse the style sheet
-	ParseStyleSheet(result, archive);
+	ParseStyleSheet(*result, archive);
 	if (!result->options.has_explicit_range) {
 		// Sniff content range if required
-		SniffRange(result, archive);
+		SniffRange(*result, archive, XLSX_FORMAT);
 	}
 	// Sniff header
-	SniffHeader(result, archive);
+	SniffHeader(*result, archive, XLSX_FORMAT);
+	if (!table_columns.empty() && result->options.column_names.empty()) {
+		// Use the column names of the table, unless given explicitly
+		D_ASSERT(table_columns.size() == result->column_names.size());
+		result->column_names = table_columns;
+	}
 }
 
 //-------------------------------------------------------------------
 // Bind
 //-------------------------------------------------------------------
 
+// Whether an entry of a streamed archive is needed to read a workbook
+static bool IsWorkbookPart(const string &name) {
+	static const char *skipped_dirs[] = {"docProps/",     "xl/media/",  "xl/embeddings/", "xl/printerSettings/",
+	                                     "xl/drawings/",  "xl/charts/", "xl/theme/",      "xl/externalLinks/",
+	                                     "customXml/",    "xl/pivotCache/"};
+	for (const auto dir : skipped_dirs) {
+		if (StringUtil::StartsWith(name, dir)) {
+			return false;
+		}
+	}
+	return StringUtil::EndsWith(name, ".xml") || StringUtil::EndsWith(name, ".rels") ||
+	       (StringUtil::EndsWith(name, ".bin") && name != "xl/vbaProject.bin");
+}
+
+// Keeps the parts of a streamed archive that are needed to read the workbook. We don't know which sheet to read
+// until we've seen the workbook and its relations, so the sheets in front of those are all kept. After that, only
+// the selected sheet is kept, unless we read a table or defined name, which are resolved from parts further down.
+class StreamedWorkbookFilter final : public ZipStreamFilter {
+public:
+	StreamedWorkbookFilter(const XLSXReadOptions &options_p, const XLSXWorkbookFormat &format_p)
+	    : options(options_p), format(format_p) {
+	}
+
+	bool KeepEntry(const string &name) override {
+		return IsWorkbookPart(name) && skipped_sheets.find(name) == skipped_sheets.end();
+	}
+
+	bool InspectEntry(const string &name) override {
+		return name == format.workbook_path || name == format.workbook_rels_path;
+	}
+
+	void OnEntry(const string &name, ZipFileReader &reader) override {
+		if (name == format.workbook_path) {
+			sheets = format.get_sheets(reader);
+			has_sheets = true;
+		} else {
+			wbrels = RelParser::ParseRelations(reader);
+			has_rels = true;
+		}
+		if (has_sheets && has_rels) {
+			SkipOtherSheets();
+		}
+	}
+
+private:
+	void SkipOtherSheets() {
+		if (!options.table_name.empty() || !options.defined_name.empty()) {
+			return;
+		}
+		// Pick the sheet just like SelectSheet does. If it doesn't exist we keep everything, binding fails anyway
+		const auto sheet_paths = ReadXLSX::GetSheetPaths(sheets, wbrels);
+		string selected_path;
+		for (auto &sheet : sheet_paths) {
+			if (options.sheet.empty() || sheet.first == options.sheet) {
+				selected_path = sheet.second;
+				break;
+			}
+		}
+		if (selected_path.empty()) {
+			return;
+		}
+		for (auto &sheet : sheet_paths) {
+			if (sheet.second != selected_path) {
+				skipped_sheets.insert(sheet.second);
+			}
+		}
+	}
+
+	const XLSXReadOptions &options;
+	const XLSXWorkbookFormat &format;
+
+	bool has_sheets = false;
+	bool has_rels = false;
+	vector<pair<string, string>> sheets;
+	vector<XLSXRelation> wbrels;
+	unordered_set<string> skipped_sheets;
+};
+
+void ReadXLSX::BindInput(ClientContext &context, XLSXReadData &result, const Value &input,
+                         const string &function_name, const XLSXWorkbookFormat &format) {
+	if (input.IsNull()) {
+		throw BinderException("%s: input can not be NULL", function_name);
+	}
+	if (input.type().id() == LogicalTypeId::BLOB) {
+		// Read the workbook straight from memory, this is only used in error messages
+		result.file_path = "<blob>";
+		result.file_data = make_shared_ptr<const string>(StringValue::Get(input));
+		return;
+	}
+	result.file_path = StringValue::Get(input);
+
+	// The zip reader needs to seek to the central directory at the end of the file. If we can't do that, e.g. when
+	// reading from a pipe or a compressed file, walk the archive front to back once and keep what we need in memory.
+	// The buffer is allocated by the buffer manager, so it counts towards the memory limit.
+	auto &fs = FileSystem::GetFileSystem(context);
+	const auto is_pipe = fs.IsPipe(result.file_path);
+	if (!is_pipe && !StringUtil::EndsWith(StringUtil::Lower(result.file_path), ".gz")) {
+		return;
+	}
+	auto handle = fs.OpenFile(result.file_path, FileFlags::FILE_FLAGS_READ | FileCompressionType::AUTO_DETECT);
+	if (!is_pipe && handle->CanSeek()) {
+		return;
+	}
+	StreamedWorkbookFilter filter(result.options, format);
+	auto &buffer_manager = BufferManager::GetBufferManager(context);
+	result.stream_data =
+	    make_shared_ptr<const ZipStreamBuffer>(ZipFileReader::BufferStream(buffer_manager, *handle, filter));
+}
+
+ZipFileReader ReadXLSX::OpenArchive(ClientContext &context, const XLSXReadData &data) {
+	if (data.file_data) {
+		return ZipFileReader(data.file_data->data(), data.file_data->size());
+	}
+	if (data.stream_data) {
+		return ZipFileReader(data.stream_data->GetData(), data.stream_data->GetSize());
+	}
+	return ZipFileReader(context, data.file_path);
+}
+
 static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindInput &input,
                                      vector<LogicalType> &return_types, vector<string> &names) {
 	auto result = make_uniq<XLSXReadData>();
-	// Get the file name
-	const auto file_path = StringValue::Get(input.inputs[0]);
-	result->file_path = file_path;
-
-	// Open the archive
-	ZipFileReader archive(context, file_path);
 
 	// Parse the options
 	ReadXLSX::ParseOptions(result->options, input.named_parameters);
 
+	// Get the file name, or the file itself
+	ReadXLSX::BindInput(context, *result, input.inputs[0], input.table_function.name, ReadXLSX::XLSX_FORMAT);
+
+	// Open the archive
+	auto archive = ReadXLSX::OpenArchive(context, *result);
+
 	// Resolve the sheet
 	ReadXLSX::ResolveSheet(result, archive);
 
@@ -317,44 +863,107 @@ static unique_ptr<FunctionData> Bind(ClientContext &context, TableFunctionBindIn
 	return std::move(result);
 }
 
+//-------------------------------------------------------------------
+// Scan Profile
+//-------------------------------------------------------------------
+// Counters and timers collected while scanning, to tell where the time
+// goes for a slow scan. These are shown in the extra info of the scan
+// operator in EXPLAIN ANALYZE.
+//-------------------------------------------------------------------
+struct XLSXScanProfile {
+	idx_t compressed_bytes = 0;
+	idx_t shared_strings = 0;
+	idx_t shared_strings_bytes = 0;
+	idx_t rows_skipped = 0;
+	idx_t rows_padded = 0;
+	idx_t cast_failures = 0;
+
+	// Seconds spent in each phase
+	double strings_time = 0;
+	double inflate_time = 0;
+	double parse_time = 0;
+	double pad_time = 0;
+	double cast_time = 0;
+};
+
 //-------------------------------------------------------------------
 // Global State
 //-------------------------------------------------------------------
 class XLSXGlobalState final : public GlobalTableFunctionState {
 public:
-	explicit XLSXGlobalState(ClientContext &context, const string &file_name, const XLSXCellRange &range,
+	explicit XLSXGlobalState(ClientContext &context, const XLSXReadData &data, const XLSXCellRange &range,
 	                         bool stop_at_empty)
-	    : archive(context, file_name), strings(BufferAllocator::Get(context)),
+	    : archive(ReadXLSX::OpenArchive(context, data)), strings(BufferManager::GetBufferManager(context)),
 	      parser(context, range, strings, stop_at_empty),
 	      buffer(make_unsafe_uniq_array_uninitialized<char>(BUFFER_SIZE)), cast_vec(LogicalType::DOUBLE) {
+		ReadXLSX::InitParser(data, parser);
 	}
 
 	ZipFileReader archive;
 	StringTable strings;
+	// Memory reserved for the string table
+	unique_ptr<TemporaryMemoryState> strings_memory;
 	SheetParser parser;
 	unsafe_unique_array<char> buffer;
 
 	XMLParseResult status = XMLParseResult::OK;
 
-	string cast_err;
 	Vector cast_vec;
 
 	atomic<idx_t> stream_pos = {0};
 	idx_t stream_len = 0;
 
+	XLSXScanProfile profile;
+
 	// 8kb buffer
 	static constexpr auto BUFFER_SIZE = 8096;
 };
 
+bool ReadXLSX::ReserveStringTable(ClientContext &context, StringTable &strings,
+                                  unique_ptr<TemporaryMemoryState> &memory, const idx_t estimated_size,
+                                  const idx_t parse_size) {
+	auto &memory_manager = TemporaryMemoryManager::Get(context);
+	memory = memory_manager.Register(context);
+	memory->SetRemainingSizeAndUpdateReservation(context, estimated_size + parse_size);
+	const auto reservation = memory->GetReservation();
+	strings.SetSpillable(reservation < estimated_size);
+	return reservation >= estimated_size + parse_size;
+}
+
+void ReadXLSX::ShrinkStringTableReservation(ClientContext &context, const StringTable &strings,
+                                            TemporaryMemoryState &memory) {
+	// A spillable table does not need to stay in memory, so there is nothing to reserve for it
+	const auto actual_size = strings.IsSpillable() ? 0 : strings.GetSizeInBytes();
+	memory.SetRemainingSizeAndUpdateReservation(context, actual_size);
+}
+
 static unique_ptr<GlobalTableFunctionState> InitGlobal(ClientContext &context, TableFunctionInitInput &input) {
 	auto &data = input.bind_data->Cast<XLSXReadData>();
 	auto &options = data.options;
-	auto state = make_uniq<XLSXGlobalState>(context, data.file_path, data.options.range, options.stop_at_empty);
+	auto state = make_uniq<XLSXGlobalState>(context, data, data.options.range, options.stop_at_empty);
 
 	// Check if there is a string table. If there is, extract it
 	if (state->archive.TryOpenEntry("xl/sharedStrings.xml")) {
-		SharedStringParser::ParseStringTable(state->archive, state->strings);
+		Profiler timer;
+		timer.Start();
+
+		// The inflated entry is an upper bound for the size of the string table. Parsing it in parallel needs a copy
+		// of the inflated entry as well, so only do so if we can reserve memory for both
+		const auto entry_len = state->archive.GetEntryLen();
+		const auto parse_size = SharedStringParser::CanParseInParallel(context, entry_len) ? entry_len : 0;
+		const auto parallel =
+		    ReadXLSX::ReserveStringTable(context, state->strings, state->strings_memory, entry_len, parse_size) &&
+		    parse_size != 0;
+
+		SharedStringParser::ParseStringTable(context, state->archive, state->strings, parallel);
 		state->archive.CloseEntry();
+
+		ReadXLSX::ShrinkStringTableReservation(context, state->strings, *state->strings_memory);
+
+		timer.End();
+		state->profile.strings_time = timer.Elapsed();
+		state->profile.shared_strings = state->strings.Count();
+		state->profile.shared_strings_bytes = state->strings.GetSizeInBytes();
 	}
 
 	// Open the main sheet for reading
@@ -366,6 +975,7 @@ static unique_ptr<GlobalTableFunctionState> InitGlobal(ClientContext &context, T
 	// Set the progress counters
 	state->stream_len = state->archive.GetEntryLen();
 	state->stream_pos = 0;
+	state->profile.compressed_bytes = state->archive.GetEntryCompressedLen();
 
 	return std::move(state);
 }
@@ -402,66 +1012,202 @@ int64_t ExcelToEpochUS(const double serial) {
 	return static_cast<int64_t>(epoch_micros);
 }
 
-static void TryCast(XLSXGlobalState &state, bool ignore_errors, const idx_t col_idx, ClientContext &context,
-                    Vector &target_col) {
+// Returns the number of cells that failed to cast (and were set to NULL), only non-zero if errors are ignored
+static idx_t TryCast(SheetParser &parser, bool ignore_errors, const idx_t col_idx, ClientContext &context,
+                     Vector &source_col, Vector &target_col) {
+	const auto row_count = parser.GetChunk().size();
 
-	auto &chunk = state.parser.GetChunk();
-	auto &source_col = chunk.data[col_idx];
-	const auto row_count = chunk.size();
+	string cast_err;
+	const auto ok = VectorOperations::TryCast(context, source_col, target_col, row_count, &cast_err);
+	if (ok) {
+		return 0;
+	}
 
-	const auto ok = VectorOperations::TryCast(context, source_col, target_col, row_count, &state.cast_err);
-	if (!ok && !ignore_errors) {
-		// Figure out which cell failed
-		const auto &source_validity = FlatVector::Validity(source_col);
-		const auto &target_validity = FlatVector::Validity(target_col);
-		for (idx_t row_idx = 0; row_idx < row_count; row_idx++) {
-			if (source_validity.RowIsValid(row_idx) != target_validity.RowIsValid(row_idx)) {
-				const auto cell_name = state.parser.GetCellName(row_idx, col_idx);
-				throw InvalidInputException("read_xlsx: Failed to parse cell '%s': %s", cell_name, state.cast_err);
+	// Figure out which cells failed
+	idx_t failures = 0;
+	UnifiedVectorFormat source_format;
+	source_col.ToUnifiedFormat(row_count, source_format);
+	const auto &target_validity = FlatVector::Validity(target_col);
+	for (idx_t row_idx = 0; row_idx < row_count; row_idx++) {
+		const auto source_valid = source_format.validity.RowIsValid(source_format.sel->get_index(row_idx));
+		if (source_valid != target_validity.RowIsValid(row_idx)) {
+			if (!ignore_errors) {
+				const auto cell_name = parser.GetCellName(row_idx, col_idx);
+				throw InvalidInputException("read_xlsx: Failed to parse cell '%s': %s", cell_name, cast_err);
 			}
+			failures++;
 		}
 	}
+	return failures;
 }
 
-static void TryCastTime(XLSXGlobalState &state, bool ignore_errors, const idx_t col_idx, ClientContext &context,
-                        Vector &target_col) {
-	// First cast it to a double
-	TryCast(state, ignore_errors, col_idx, context, state.cast_vec);
+static idx_t TryCast(SheetParser &parser, bool ignore_errors, const idx_t col_idx, ClientContext &context,
+                     Vector &target_col) {
+	return TryCast(parser, ignore_errors, col_idx, context, parser.GetChunk().data[col_idx], target_col);
+}
 
-	// Then convert the double to a time
-	const auto row_count = state.parser.GetChunk().size();
-	UnaryExecutor::Execute<double, dtime_t>(state.cast_vec, target_col, row_count, [&](const double &input) {
-		const auto epoch_us = ExcelToEpochUS(input);
-		const auto stamp = Timestamp::FromEpochMicroSeconds(epoch_us);
-		return Timestamp::GetTime(stamp);
-	});
+bool ReadXLSX::IsExcelSerialType(const LogicalType &type) {
+	switch (type.id()) {
+	case LogicalTypeId::DATE:
+	case LogicalTypeId::TIME:
+	case LogicalTypeId::TIME_TZ:
+	case LogicalTypeId::TIMESTAMP:
+	case LogicalTypeId::TIMESTAMP_TZ:
+	case LogicalTypeId::TIMESTAMP_SEC:
+	case LogicalTypeId::TIMESTAMP_MS:
+	case LogicalTypeId::TIMESTAMP_NS:
+		return true;
+	default:
+		return false;
+	}
 }
 
-static void TryCastDate(XLSXGlobalState &state, bool ignore_errors, const idx_t col_idx, ClientContext &context,
-                        Vector &target_col) {
-	// First cast it to a double
-	TryCast(state, ignore_errors, col_idx, context, state.cast_vec);
+void ReadXLSX::InitParser(const XLSXReadData &bind_data, SheetParser &parser) {
+	for (idx_t col_idx = 0; col_idx < bind_data.return_types.size(); col_idx++) {
+		if (bind_data.source_types[col_idx] == XLSXCellType::NUMBER &&
+		    IsExcelSerialType(bind_data.return_types[col_idx])) {
+			parser.TrackNumberCells(col_idx);
+		}
+	}
+}
 
-	// Then convert the double to a date
-	const auto row_count = state.parser.GetChunk().size();
-	UnaryExecutor::Execute<double, date_t>(state.cast_vec, target_col, row_count, [&](const double &input) {
-		const auto epoch_us = ExcelToEpochUS(input);
-		const auto stamp = Timestamp::FromEpochMicroSeconds(epoch_us);
-		return Timestamp::GetDate(stamp);
-	});
+// Convert the excel serials in cast_vec to DATE, TIME or TIMESTAMP
+static void ConvertExcelSerials(Vector &cast_vec, Vector &result, const idx_t row_count) {
+	switch (result.GetType().id()) {
+	case LogicalTypeId::DATE:
+		UnaryExecutor::Execute<double, date_t>(cast_vec, result, row_count, [&](const double &input) {
+			return Timestamp::GetDate(Timestamp::FromEpochMicroSeconds(ExcelToEpochUS(input)));
+		});
+		break;
+	case LogicalTypeId::TIME:
+		UnaryExecutor::Execute<double, dtime_t>(cast_vec, result, row_count, [&](const double &input) {
+			return Timestamp::GetTime(Timestamp::FromEpochMicroSeconds(ExcelToEpochUS(input)));
+		});
+		break;
+	case LogicalTypeId::TIMESTAMP:
+		UnaryExecutor::Execute<double, timestamp_t>(cast_vec, result, row_count, [&](const double &input) {
+			return Timestamp::FromEpochMicroSeconds(ExcelToEpochUS(input));
+		});
+		break;
+	default:
+		throw InternalException("Unexpected type for excel serial conversion");
+	}
 }
 
-static void TryCastTimestamp(XLSXGlobalState &state, bool ignore_errors, const idx_t col_idx, ClientContext &context,
-                             Vector &target_col) {
-	// First cast it to a double
-	TryCast(state, ignore_errors, col_idx, context, state.cast_vec);
+// The type excel serials are converted to, before casting them to the other temporal types
+static LogicalType GetExcelSerialType(const LogicalType &type) {
+	switch (type.id()) {
+	case LogicalTypeId::DATE:
+		return LogicalType::DATE;
+	case LogicalTypeId::TIME:
+	case LogicalTypeId::TIME_TZ:
+		return LogicalType::TIME;
+	default:
+		return LogicalType::TIMESTAMP;
+	}
+}
+
+// Convert a column of a temporal type. Cells holding numbers are converted from excel serials, any other cells (text,
+// or ISO 8601 dates) are cast from their string value, so a single text cell does not break the rest of the column.
+static idx_t TryCastTemporal(SheetParser &parser, Vector &cast_vec, bool ignore_errors, const idx_t col_idx,
+                             ClientContext &context, Vector &target_col) {
+	auto &chunk = parser.GetChunk();
+	auto &source_col = chunk.data[col_idx];
+	const auto row_count = chunk.size();
+
+	if (source_col.GetVectorType() == VectorType::CONSTANT_VECTOR) {
+		// There is no data in this column
+		return TryCast(parser, ignore_errors, col_idx, context, target_col);
+	}
+
+	// Split the column into the number cells and the other cells
+	const auto &source_validity = FlatVector::Validity(source_col);
+	const auto &number_cells = parser.GetNumberCells(col_idx);
+	ValidityMask number_validity(row_count);
+	ValidityMask text_validity(row_count);
+	idx_t text_count = 0;
+	for (idx_t row_idx = 0; row_idx < row_count; row_idx++) {
+		if (!source_validity.RowIsValid(row_idx)) {
+			number_validity.SetInvalid(row_idx);
+			text_validity.SetInvalid(row_idx);
+		} else if (number_cells.RowIsValid(row_idx)) {
+			text_validity.SetInvalid(row_idx);
+		} else {
+			number_validity.SetInvalid(row_idx);
+			text_count++;
+		}
+	}
 
-	// Then convert the double to a timestamp
-	const auto row_count = state.parser.GetChunk().size();
-	UnaryExecutor::Execute<double, timestamp_t>(state.cast_vec, target_col, row_count, [&](const double &input) {
-		const auto epoch_us = ExcelToEpochUS(input);
-		return Timestamp::FromEpochMicroSeconds(epoch_us);
-	});
+	// Convert the numbers from excel serials, casting them to the target type if it is not the one we convert to
+	Vector number_col(source_col);
+	FlatVector::SetValidity(number_col, number_validity);
+	idx_t failures = TryCast(parser, ignore_errors, col_idx, context, number_col, cast_vec);
+
+	const auto serial_type = GetExcelSerialType(target_col.GetType());
+	if (serial_type == target_col.GetType()) {
+		ConvertExcelSerials(cast_vec, target_col, row_count);
+	} else {
+		Vector serial_col(serial_type, row_count);
+		ConvertExcelSerials(cast_vec, serial_col, row_count);
+		failures += TryCast(parser, ignore_errors, col_idx, context, serial_col, target_col);
+	}
+	if (text_count == 0) {
+		return failures;
+	}
+
+	// Then cast the other cells from their string value, and fill them in
+	Vector text_col(source_col);
+	FlatVector::SetValidity(text_col, text_validity);
+	Vector text_result(target_col.GetType(), row_count);
+	failures += TryCast(parser, ignore_errors, col_idx, context, text_col, text_result);
+
+	target_col.Flatten(row_count);
+	const auto width = GetTypeIdSize(target_col.GetType().InternalType());
+	const auto source_data = FlatVector::GetData(text_result);
+	const auto target_data = FlatVector::GetData(target_col);
+	const auto &result_validity = FlatVector::Validity(text_result);
+	auto &target_validity = FlatVector::Validity(target_col);
+	for (idx_t row_idx = 0; row_idx < row_count; row_idx++) {
+		if (result_validity.RowIsValid(row_idx)) {
+			memcpy(target_data + row_idx * width, source_data + row_idx * width, width);
+			target_validity.SetValid(row_idx);
+		}
+	}
+	return failures;
+}
+
+idx_t ReadXLSX::CastChunk(ClientContext &context, const XLSXReadData &bind_data, SheetParser &parser,
+                          Vector &cast_vec, DataChunk &output) {
+	auto &options = bind_data.options;
+	auto &chunk = parser.GetChunk();
+
+	// Cast all the strings to the correct types, unless they are already strings in which case we reference them
+	const auto row_count = chunk.size();
+	idx_t failures = 0;
+
+	for (idx_t col_idx = 0; col_idx < output.ColumnCount(); col_idx++) {
+		auto &source_col = chunk.data[col_idx];
+		auto &target_col = output.data[col_idx];
+		auto &xlsx_type = bind_data.source_types[col_idx];
+
+		const auto source_type = source_col.GetType().id();
+		const auto target_type = target_col.GetType().id();
+
+		if (source_type == target_type) {
+			// If the types are the same, reference the column
+			target_col.Reference(source_col);
+		} else if (xlsx_type == XLSXCellType::NUMBER && IsExcelSerialType(target_col.GetType())) {
+			failures += TryCastTemporal(parser, cast_vec, options.ignore_errors, col_idx, context, target_col);
+		} else {
+			// Cast the from string to the target type
+			failures += TryCast(parser, options.ignore_errors, col_idx, context, target_col);
+		}
+	}
+	output.SetCapacity(row_count);
+	output.SetCardinality(row_count);
+
+	output.Verify();
+	return failures;
 }
 
 static void Execute(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
@@ -473,10 +1219,13 @@ static void Execute(ClientContext &context, TableFunctionInput &data, DataChunk
 	auto &stream = gstate.archive;
 	auto &parser = gstate.parser;
 	auto &status = gstate.status;
+	auto &profile = gstate.profile;
+
+	Profiler timer;
 
 	// Ready the chunk
 	auto &chunk = parser.GetChunk();
-	chunk.Reset();
+	parser.ResetChunk();
 
 	while (chunk.size() != STANDARD_VECTOR_SIZE) {
 		if (status == XMLParseResult::SUSPENDED) {
@@ -485,12 +1234,20 @@ static void Execute(ClientContext &context, TableFunctionInput &data, DataChunk
 					status = XMLParseResult::ABORTED;
 					break;
 				}
+				const auto skip_beg = chunk.size();
+				timer.Start();
 				parser.SkipRows();
+				timer.End();
+				profile.pad_time += timer.Elapsed();
+				profile.rows_skipped += chunk.size() - skip_beg;
 				continue;
 			}
 
 			// Resume normally
+			timer.Start();
 			status = parser.Resume();
+			timer.End();
+			profile.parse_time += timer.Elapsed();
 			continue;
 		}
 		if (stream.IsDone()) {
@@ -501,48 +1258,69 @@ static void Execute(ClientContext &context, TableFunctionInput &data, DataChunk
 		}
 
 		// Otherwise, read more data
+		timer.Start();
 		const auto read_size = stream.Read(buffer, XLSXGlobalState::BUFFER_SIZE);
+		timer.End();
+		profile.inflate_time += timer.Elapsed();
 
 		// Update the progess
 		gstate.stream_pos += read_size;
 
+		timer.Start();
 		status = parser.Parse(buffer, read_size, stream.IsDone());
+		timer.End();
+		profile.parse_time += timer.Elapsed();
 	}
 
 	// Pad with empty rows if wanted (and needed)
 	if (options.has_explicit_range) {
+		const auto pad_beg = chunk.size();
+		timer.Start();
 		parser.FillRows();
+		timer.End();
+		profile.pad_time += timer.Elapsed();
+		profile.rows_padded += chunk.size() - pad_beg;
 	}
 
-	// Cast all the strings to the correct types, unless they are already strings in which case we reference them
-	const auto row_count = chunk.size();
-
-	for (idx_t col_idx = 0; col_idx < output.ColumnCount(); col_idx++) {
-		auto &source_col = chunk.data[col_idx];
-		auto &target_col = output.data[col_idx];
-		auto &xlsx_type = bind_data.source_types[col_idx];
+	timer.Start();
+	profile.cast_failures += ReadXLSX::CastChunk(context, bind_data, parser, gstate.cast_vec, output);
+	timer.End();
+	profile.cast_time += timer.Elapsed();
+}
 
-		const auto source_type = source_col.GetType().id();
-		const auto target_type = target_col.GetType().id();
+//-------------------------------------------------------------------
+// Profile
+//-------------------------------------------------------------------
+static string FormatSeconds(const double seconds) {
+	return StringUtil::Format("%.3fs", seconds);
+}
 
-		if (source_type == target_type) {
-			// If the types are the same, reference the column
-			target_col.Reference(source_col);
-		} else if (xlsx_type == XLSXCellType::NUMBER && target_type == LogicalTypeId::TIME) {
-			TryCastTime(gstate, options.ignore_errors, col_idx, context, target_col);
-		} else if (xlsx_type == XLSXCellType::NUMBER && target_type == LogicalTypeId::DATE) {
-			TryCastDate(gstate, options.ignore_errors, col_idx, context, target_col);
-		} else if (xlsx_type == XLSXCellType::NUMBER && target_type == LogicalTypeId::TIMESTAMP) {
-			TryCastTimestamp(gstate, options.ignore_errors, col_idx, context, target_col);
-		} else {
-			// Cast the from string to the target type
-			TryCast(gstate, options.ignore_errors, col_idx, context, target_col);
-		}
+static InsertionOrderPreservingMap<string> DynamicToString(GlobalTableFunctionState *global_state) {
+	InsertionOrderPreservingMap<string> result;
+	if (!global_state) {
+		return result;
 	}
-	output.SetCapacity(row_count);
-	output.SetCardinality(row_count);
 
-	output.Verify();
+	auto &state = global_state->Cast<XLSXGlobalState>();
+	const auto &profile = state.profile;
+	const auto &parser = state.parser;
+
+	result["Compressed Bytes"] = std::to_string(profile.compressed_bytes);
+	result["Inflated Bytes"] = std::to_string(state.stream_pos.load());
+	result["XML Elements"] = std::to_string(parser.GetElementCount());
+	result["Rows"] = std::to_string(parser.GetRowCount());
+	result["Cells"] = std::to_string(parser.GetCellCount());
+	result["Rows Skipped"] = std::to_string(profile.rows_skipped);
+	result["Rows Padded"] = std::to_string(profile.rows_padded);
+	result["Shared Strings"] = std::to_string(profile.shared_strings);
+	result["Shared Strings Bytes"] = std::to_string(profile.shared_strings_bytes);
+	result["Cast Failures"] = std::to_string(profile.cast_failures);
+	result["Shared Strings Time"] = FormatSeconds(profile.strings_time);
+	result["Inflate Time"] = FormatSeconds(profile.inflate_time);
+	result["Parse Time"] = FormatSeconds(profile.parse_time);
+	result["Pad Time"] = FormatSeconds(profile.pad_time);
+	result["Cast Time"] = FormatSeconds(profile.cast_time);
+	return result;
 }
 
 //-------------------------------------------------------------------
@@ -586,6 +1364,7 @@ TableFunction ReadXLSX::GetFunction() {
 	TableFunction read_xlsx("read_xlsx", {LogicalType::VARCHAR}, Execute, Bind);
 	read_xlsx.init_global = InitGlobal;
 	read_xlsx.table_scan_progress = Progress;
+	read_xlsx.dynamic_to_string = DynamicToString;
 
 	// Parameters
 	read_xlsx.named_parameters["header"] = LogicalType::BOOLEAN;
@@ -595,12 +1374,23 @@ TableFunction ReadXLSX::GetFunction() {
 	read_xlsx.named_parameters["sheet"] = LogicalType::VARCHAR;
 	read_xlsx.named_parameters["stop_at_empty"] = LogicalType::BOOLEAN;
 	read_xlsx.named_parameters["empty_as_varchar"] = LogicalType::BOOLEAN;
+	read_xlsx.named_parameters["table"] = LogicalType::VARCHAR;
+	read_xlsx.named_parameters["name"] = LogicalType::VARCHAR;
+	read_xlsx.named_parameters["columns"] = LogicalType::ANY;
+	read_xlsx.named_parameters["types"] = LogicalType::LIST(LogicalType::VARCHAR);
 
 	return read_xlsx;
 }
 
 void ReadXLSX::Register(DatabaseInstance &db) {
-	ExtensionUtil::RegisterFunction(db, GetFunction());
+	// Workbooks can also be read from a BLOB, e.g. one stored in a table, without going through the file system
+	TableFunctionSet read_xlsx("read_xlsx");
+	auto read_file = GetFunction();
+	auto read_blob = read_file;
+	read_blob.arguments = {LogicalType::BLOB};
+	read_xlsx.AddFunction(std::move(read_file));
+	read_xlsx.AddFunction(std::move(read_blob));
+	ExtensionUtil::RegisterFunction(db, read_xlsx);
 	db.config.replacement_scans.emplace_back(XLSXReplacementScan);
 }
 
@@ -0,0 +1,297 @@
+#include "xlsx/read_xlsx.hpp"
+#include "xlsx/zip_file.hpp"
+#include "xlsx/parsers/relationship_parser.hpp"
+#include "xlsx/parsers/workbook_parser.hpp"
+#include "xlsx/parsers/worksheet_parser.hpp"
+
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/main/extension_util.hpp"
+
+namespace duckdb {
+
+//-------------------------------------------------------------------
+// Metadata
+//-------------------------------------------------------------------
+// xlsx_sheets lists the sheets of one or more workbooks, reading only
+// the workbook and its relations.
+//
+// xlsx_metadata additionally inspects the beginning of every sheet to
+// get its <dimension>, header and column types, the same way read_xlsx
+// would bind it. Only the shared strings referenced by the header are
+// looked up, and the sheet data is never read past the first data row.
+//
+// Files are inspected in parallel, one file per thread at a time.
+//-------------------------------------------------------------------
+
+struct XLSXSheetInfo {
+	string file_path;
+	idx_t sheet_index = 0;
+	string sheet_name;
+	string sheet_path;
+
+	// Only set for xlsx_metadata
+	string dimension;
+	bool has_estimated_rows = false;
+	idx_t estimated_rows = 0;
+	bool has_columns = false;
+	vector<string> column_names;
+	vector<LogicalType> column_types;
+};
+
+struct XLSXMetadataData final : public TableFunctionData {
+	vector<string> files;
+	XLSXReadOptions options;
+	bool inspect_sheets = false;
+};
+
+//-------------------------------------------------------------------
+// Bind
+//-------------------------------------------------------------------
+static vector<string> GetFiles(ClientContext &context, const Value &input) {
+	vector<string> patterns;
+	if (input.type().id() == LogicalTypeId::LIST) {
+		for (auto &child : ListValue::GetChildren(input)) {
+			if (child.IsNull()) {
+				throw BinderException("File paths can not be NULL");
+			}
+			patterns.push_back(StringValue::Get(child));
+		}
+	} else {
+		patterns.push_back(StringValue::Get(input));
+	}
+
+	auto &fs = FileSystem::GetFileSystem(context);
+	vector<string> result;
+	for (auto &pattern : patterns) {
+		auto files = fs.GlobFiles(pattern, context, FileGlobOptions::DISALLOW_EMPTY);
+		result.insert(result.end(), files.begin(), files.end());
+	}
+	return result;
+}
+
+static unique_ptr<FunctionData> BindCommon(ClientContext &context, TableFunctionBindInput &input,
+                                           const bool inspect_sheets) {
+	if (input.inputs[0].IsNull()) {
+		throw BinderException("%s: path can not be NULL", input.table_function.name);
+	}
+
+	auto result = make_uniq<XLSXMetadataData>();
+	result->files = GetFiles(context, input.inputs[0]);
+	result->inspect_sheets = inspect_sheets;
+	ReadXLSX::ParseOptions(result->options, input.named_parameters);
+	return std::move(result);
+}
+
+static unique_ptr<FunctionData> BindSheets(ClientContext &context, TableFunctionBindInput &input,
+                                           vector<LogicalType> &return_types, vector<string> &names) {
+	names = {"file", "sheet_index", "sheet_name"};
+	return_types = {LogicalType::VARCHAR, LogicalType::BIGINT, LogicalType::VARCHAR};
+	return BindCommon(context, input, false);
+}
+
+static unique_ptr<FunctionData> BindMetadata(ClientContext &context, TableFunctionBindInput &input,
+                                             vector<LogicalType> &return_types, vector<string> &names) {
+	names = {"file", "sheet_index", "sheet_name", "dimension", "estimated_rows", "column_names", "column_types"};
+	return_types = {LogicalType::VARCHAR,
+	                LogicalType::BIGINT,
+	                LogicalType::VARCHAR,
+	                LogicalType::VARCHAR,
+	                LogicalType::BIGINT,
+	                LogicalType::LIST(LogicalType::VARCHAR),
+	                LogicalType::LIST(LogicalType::VARCHAR)};
+	return BindCommon(context, input, true);
+}
+
+//-------------------------------------------------------------------
+// Inspect
+//-------------------------------------------------------------------
+static void InspectSheet(const XLSXMetadataData &bind_data, const XLSXStyleSheet &style_sheet,
+                         ZipFileReader &archive, XLSXSheetInfo &info) {
+
+	// Find the first row with data, this also picks up the <dimension> element in front of the sheet data
+	if (!archive.TryOpenEntry(info.sheet_path)) {
+		throw InvalidInputException("Sheet '%s' not found in xlsx file '%s'", info.sheet_path, info.file_path);
+	}
+	RangeSniffer range_sniffer;
+	range_sniffer.ParseAll(archive);
+	archive.CloseEntry();
+
+	info.dimension = range_sniffer.GetDimension();
+	if (range_sniffer.IsEmpty()) {
+		// Nothing to bind
+		return;
+	}
+
+	// Now sniff the header and types, just like read_xlsx would
+	XLSXReadData sheet_data;
+	sheet_data.file_path = info.file_path;
+	sheet_data.sheet_path = info.sheet_path;
+	sheet_data.style_sheet = style_sheet;
+	sheet_data.options = bind_data.options;
+	sheet_data.options.range = range_sniffer.GetRange();
+
+	ReadXLSX::SniffHeader(sheet_data, archive, ReadXLSX::XLSX_FORMAT);
+
+	info.has_columns = true;
+	info.column_names = std::move(sheet_data.column_names);
+	info.column_types = std::move(sheet_data.return_types);
+
+	// Estimate the number of data rows from the last row of the dimension
+	XLSXCellRange dimension;
+	XLSXCellPos last_cell;
+	const auto dimension_str = info.dimension.c_str();
+	if (dimension.TryParse(dimension_str)) {
+		last_cell = XLSXCellPos(dimension.end.row, dimension.end.col);
+	} else if (!last_cell.TryParse(dimension_str)) {
+		return;
+	}
+	const auto data_beg = sheet_data.options.range.beg.row;
+	info.has_estimated_rows = true;
+	info.estimated_rows = last_cell.row >= data_beg ? last_cell.row - data_beg + 1 : 0;
+}
+
+static vector<XLSXSheetInfo> InspectFile(ClientContext &context, const XLSXMetadataData &bind_data,
+                                         const string &file_path) {
+	ZipFileReader archive(context, file_path);
+
+	if (!archive.TryOpenEntry("xl/workbook.xml")) {
+		throw InvalidInputException("No xl/workbook.xml found in xlsx file '%s'", file_path);
+	}
+	const auto sheets = WorkBookParser::GetSheets(archive);
+	archive.CloseEntry();
+
+	if (!archive.TryOpenEntry("xl/_rels/workbook.xml.rels")) {
+		throw InvalidInputException("No xl/_rels/workbook.xml.rels found in xlsx file '%s'", file_path);
+	}
+	const auto wbrels = RelParser::ParseRelations(archive);
+	archive.CloseEntry();
+
+	vector<XLSXSheetInfo> result;
+	for (auto &sheet : ReadXLSX::GetSheetPaths(sheets, wbrels)) {
+		XLSXSheetInfo info;
+		info.file_path = file_path;
+		info.sheet_index = result.size();
+		info.sheet_name = sheet.first;
+		info.sheet_path = sheet.second;
+		result.push_back(std::move(info));
+	}
+
+	if (!bind_data.inspect_sheets || result.empty()) {
+		return result;
+	}
+
+	// The style sheet is shared by all sheets, so only parse it once
+	XLSXReadData style_data;
+	ReadXLSX::ParseStyleSheet(style_data, archive);
+
+	for (auto &info : result) {
+		InspectSheet(bind_data, style_data.style_sheet, archive, info);
+	}
+	return result;
+}
+
+//-------------------------------------------------------------------
+// State
+//-------------------------------------------------------------------
+struct XLSXMetadataGlobalState final : public GlobalTableFunctionState {
+	explicit XLSXMetadataGlobalState(idx_t file_count_p) : file_count(file_count_p) {
+	}
+
+	idx_t MaxThreads() const override {
+		return file_count;
+	}
+
+	idx_t file_count;
+	atomic<idx_t> next_file = {0};
+};
+
+struct XLSXMetadataLocalState final : public LocalTableFunctionState {
+	vector<XLSXSheetInfo> sheets;
+	idx_t sheet_idx = 0;
+};
+
+static unique_ptr<GlobalTableFunctionState> InitGlobal(ClientContext &context, TableFunctionInitInput &input) {
+	auto &bind_data = input.bind_data->Cast<XLSXMetadataData>();
+	return make_uniq<XLSXMetadataGlobalState>(bind_data.files.size());
+}
+
+static unique_ptr<LocalTableFunctionState> InitLocal(ExecutionContext &context, TableFunctionInitInput &input,
+                                                     GlobalTableFunctionState *global_state) {
+	return make_uniq<XLSXMetadataLocalState>();
+}
+
+//-------------------------------------------------------------------
+// Execute
+//-------------------------------------------------------------------
+static void Execute(ClientContext &context, TableFunctionInput &input, DataChunk &output) {
+	auto &bind_data = input.bind_data->Cast<XLSXMetadataData>();
+	auto &gstate = input.global_state->Cast<XLSXMetadataGlobalState>();
+	auto &lstate = input.local_state->Cast<XLSXMetadataLocalState>();
+
+	idx_t out_idx = 0;
+	while (out_idx < STANDARD_VECTOR_SIZE) {
+		if (lstate.sheet_idx == lstate.sheets.size()) {
+			// Grab the next file
+			const auto file_idx = gstate.next_file++;
+			if (file_idx >= gstate.file_count) {
+				break;
+			}
+			lstate.sheets = InspectFile(context, bind_data, bind_data.files[file_idx]);
+			lstate.sheet_idx = 0;
+			continue;
+		}
+
+		const auto &info = lstate.sheets[lstate.sheet_idx++];
+		output.SetValue(0, out_idx, Value(info.file_path));
+		output.SetValue(1, out_idx, Value::BIGINT(NumericCast<int64_t>(info.sheet_index)));
+		output.SetValue(2, out_idx, Value(info.sheet_name));
+
+		if (bind_data.inspect_sheets) {
+			output.SetValue(3, out_idx, info.dimension.empty() ? Value() : Value(info.dimension));
+			output.SetValue(4, out_idx,
+			                info.has_estimated_rows ? Value::BIGINT(NumericCast<int64_t>(info.estimated_rows))
+			                                        : Value());
+			if (info.has_columns) {
+				vector<Value> names;
+				vector<Value> types;
+				for (idx_t col_idx = 0; col_idx < info.column_names.size(); col_idx++) {
+					names.emplace_back(info.column_names[col_idx]);
+					types.emplace_back(info.column_types[col_idx].ToString());
+				}
+				output.SetValue(5, out_idx, Value::LIST(LogicalType::VARCHAR, std::move(names)));
+				output.SetValue(6, out_idx, Value::LIST(LogicalType::VARCHAR, std::move(types)));
+			} else {
+				output.SetValue(5, out_idx, Value());
+				output.SetValue(6, out_idx, Value());
+			}
+		}
+		out_idx++;
+	}
+	output.SetCardinality(out_idx);
+}
+
+//-------------------------------------------------------------------
+// Register
+//-------------------------------------------------------------------
+static TableFunctionSet GetFunctionSet(const string &name, table_function_bind_t bind, const bool has_options) {
+	TableFunctionSet set(name);
+	const vector<LogicalType> input_types = {LogicalType::VARCHAR, LogicalType::LIST(LogicalType::VARCHAR)};
+	for (auto &type : input_types) {
+		TableFunction func(name, {type}, Execute, bind, InitGlobal, InitLocal);
+		if (has_options) {
+			func.named_parameters["header"] = LogicalType::BOOLEAN;
+			func.named_parameters["all_varchar"] = LogicalType::BOOLEAN;
+			func.named_parameters["empty_as_varchar"] = LogicalType::BOOLEAN;
+		}
+		set.AddFunction(func);
+	}
+	return set;
+}
+
+void XLSXMetadata::Register(DatabaseInstance &db) {
+	ExtensionUtil::RegisterFunction(db, GetFunctionSet("xlsx_sheets", BindSheets, false));
+	ExtensionUtil::RegisterFunction(db, GetFunctionSet("xlsx_metadata", BindMetadata, true));
+}
+
+} // namespace duckdb
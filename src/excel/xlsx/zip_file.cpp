@@ -2,13 +2,23 @@
 #include "xlsx/xml_util.hpp"
 
 #include "duckdb/common/file_system.hpp"
+#include "duckdb/common/helper.hpp"
+#include "duckdb/common/limits.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
 
 #include "minizip-ng/mz.h"
 #include "minizip-ng/mz_os.h"
 #include "minizip-ng/mz_strm.h"
+#include "minizip-ng/mz_strm_mem.h"
 #include "minizip-ng/mz_zip.h"
 #include "minizip-ng/mz_zip_rw.h"
 
+#include "zlib.h"
+
+#include <deque>
+#include <thread>
+
 namespace duckdb {
 
 //-------------------------------------------------------------------------
@@ -47,8 +57,27 @@ struct mz_stream_duckdb {
 	FileSystem *fs;
 	FileHandle *handle;
 	string last_error;
+
+	// When writing, the data is collected in a buffer so that the file is written in large pieces. This is only
+	// enabled when the capacity is set
+	string write_buffer;
+	idx_t write_buffer_capacity = 0;
+	bool sync_on_close = false;
+	// Set when a file is abandoned before it was finalized, in which case nothing more is written to it
+	bool discard_writes = false;
 };
 
+static void mz_stream_duckdb_flush(mz_stream_duckdb &self) {
+	if (self.discard_writes) {
+		self.write_buffer.clear();
+	}
+	if (self.write_buffer.empty()) {
+		return;
+	}
+	self.handle->Write(const_cast<char *>(self.write_buffer.data()), self.write_buffer.size());
+	self.write_buffer.clear();
+}
+
 int32_t mz_stream_duckdb_open(void *stream, const char *path, int32_t mode) {
 	auto &self = *reinterpret_cast<mz_stream_duckdb *>(stream);
 
@@ -102,21 +131,35 @@ int32_t mz_stream_duckdb_is_open(void *stream) {
 
 int32_t mz_stream_duckdb_read(void *stream, void *buf, int32_t size) {
 	auto &self = *reinterpret_cast<mz_stream_duckdb *>(stream);
+	mz_stream_duckdb_flush(self);
 	return self.handle->Read(buf, size);
 }
 
 int32_t mz_stream_duckdb_write(void *stream, const void *buf, int32_t size) {
 	auto &self = *reinterpret_cast<mz_stream_duckdb *>(stream);
-	return self.handle->Write(const_cast<void *>(buf), size);
+	const auto write_size = static_cast<idx_t>(size);
+	if (self.discard_writes) {
+		return size;
+	}
+	if (self.write_buffer.size() + write_size > self.write_buffer_capacity) {
+		mz_stream_duckdb_flush(self);
+		if (write_size >= self.write_buffer_capacity) {
+			// Too large to buffer, write it right away
+			return self.handle->Write(const_cast<void *>(buf), write_size);
+		}
+	}
+	self.write_buffer.append(static_cast<const char *>(buf), write_size);
+	return size;
 }
 
 int64_t mz_stream_duckdb_tell(void *stream) {
 	auto &self = *reinterpret_cast<mz_stream_duckdb *>(stream);
-	return self.handle->SeekPosition();
+	return self.handle->SeekPosition() + self.write_buffer.size();
 }
 
 int32_t mz_stream_duckdb_seek(void *stream, int64_t offset, int32_t origin) {
 	auto &self = *reinterpret_cast<mz_stream_duckdb *>(stream);
+	mz_stream_duckdb_flush(self);
 	switch (origin) {
 	case MZ_SEEK_SET:
 		self.handle->Seek(offset);
@@ -136,7 +179,10 @@ int32_t mz_stream_duckdb_seek(void *stream, int64_t offset, int32_t origin) {
 
 int32_t mz_stream_duckdb_close(void *stream) {
 	auto &self = *reinterpret_cast<mz_stream_duckdb *>(stream);
-	self.handle->Sync();
+	mz_stream_duckdb_flush(self);
+	if (self.sync_on_close) {
+		self.handle->Sync();
+	}
 	self.handle->Close();
 	return MZ_OK;
 }
@@ -159,7 +205,6 @@ void mz_stream_duckdb_delete(void **stream) {
 	}
 	auto &self = *reinterpret_cast<mz_stream_duckdb *>(*stream);
 	if (self.handle) {
-		self.handle->Sync();
 		self.handle->Close();
 		self.handle->~FileHandle();
 		self.handle = nullptr;
@@ -169,20 +214,243 @@ void mz_stream_duckdb_delete(void **stream) {
 }
 // NOLINTEND
 
+//-------------------------------------------------------------------------
+// Block Deflater
+//-------------------------------------------------------------------------
+// Deflates the data of an entry in independent blocks, like pigz does,
+// so that multiple threads can compress it at once. Every block is
+// compressed with the last 32KB of the data before it as dictionary,
+// and ends with a sync flush, which aligns it to a byte boundary
+// without ending the deflate stream. The compressed blocks are then
+// written in order as one deflate stream, and the CRC32s of the blocks
+// are combined into the CRC32 of the entry.
+//-------------------------------------------------------------------------
+
+static constexpr idx_t DEFLATE_BLOCK_SIZE = 256 * 1024;
+static constexpr idx_t DEFLATE_DICT_SIZE = 32 * 1024;
+// The number of blocks waiting to be compressed before the writing thread compresses them itself
+static constexpr idx_t DEFLATE_MAX_PENDING_BLOCKS = 8;
+
+struct ZipDeflateBlock {
+	string input;
+	string dictionary;
+	string output;
+	idx_t input_size = 0;
+	uint32_t crc = 0;
+	int level = Z_DEFAULT_COMPRESSION;
+	bool is_last = false;
+	bool is_done = false;
+};
+
+class ZipBlockDeflater {
+public:
+	explicit ZipBlockDeflater(void *zip_handle_p) : zip_handle(zip_handle_p) {
+	}
+
+	void Begin(int level);
+	void Write(const char *buffer, idx_t write_size);
+	// Compress the next block waiting to be compressed, if any, and write the blocks that are done
+	bool CompressNext();
+	// Compress the remaining data, and wait for the blocks being compressed by other threads
+	void Finish();
+
+	idx_t GetUncompressedSize() const {
+		return uncompressed_size;
+	}
+	uint32_t GetCRC() const {
+		return crc;
+	}
+
+private:
+	void SealBlock(bool is_last);
+	void WriteBlocks();
+	static void Compress(ZipDeflateBlock &block);
+
+	void *zip_handle;
+
+	// Only used by the writing thread
+	int level = Z_DEFAULT_COMPRESSION;
+	string current;
+	string dictionary;
+	idx_t uncompressed_size = 0;
+
+	mutex lock;
+	// The blocks that have not been written yet, in order
+	std::deque<unique_ptr<ZipDeflateBlock>> blocks;
+	// The blocks that no thread is compressing yet
+	std::deque<ZipDeflateBlock *> pending;
+	uint32_t crc = 0;
+};
+
+void ZipBlockDeflater::Begin(const int level_p) {
+	level = level_p;
+	current.clear();
+	current.reserve(DEFLATE_BLOCK_SIZE);
+	dictionary.clear();
+	uncompressed_size = 0;
+
+	lock_guard<mutex> guard(lock);
+	D_ASSERT(blocks.empty());
+	crc = crc32(0, nullptr, 0);
+}
+
+void ZipBlockDeflater::Write(const char *buffer, idx_t write_size) {
+	while (write_size > 0) {
+		const auto copy_size = MinValue(write_size, DEFLATE_BLOCK_SIZE - current.size());
+		current.append(buffer, copy_size);
+		buffer += copy_size;
+		write_size -= copy_size;
+
+		if (current.size() == DEFLATE_BLOCK_SIZE) {
+			SealBlock(false);
+		}
+	}
+}
+
+void ZipBlockDeflater::SealBlock(const bool is_last) {
+	auto block = make_uniq<ZipDeflateBlock>();
+	block->level = level;
+	block->is_last = is_last;
+	block->dictionary = dictionary;
+
+	// The dictionary of the next block is the last 32KB of all data so far
+	if (current.size() >= DEFLATE_DICT_SIZE) {
+		dictionary.assign(current, current.size() - DEFLATE_DICT_SIZE, DEFLATE_DICT_SIZE);
+	} else {
+		dictionary += current;
+		if (dictionary.size() > DEFLATE_DICT_SIZE) {
+			dictionary.erase(0, dictionary.size() - DEFLATE_DICT_SIZE);
+		}
+	}
+
+	uncompressed_size += current.size();
+	block->input_size = current.size();
+	block->input = std::move(current);
+	current = string();
+	current.reserve(DEFLATE_BLOCK_SIZE);
+
+	bool compress_now;
+	{
+		lock_guard<mutex> guard(lock);
+		pending.push_back(block.get());
+		blocks.push_back(std::move(block));
+		compress_now = pending.size() > DEFLATE_MAX_PENDING_BLOCKS;
+	}
+	if (compress_now) {
+		// No one is helping out, or not fast enough, compress a block ourselves
+		CompressNext();
+	}
+}
+
+void ZipBlockDeflater::Compress(ZipDeflateBlock &block) {
+	z_stream zs;
+	memset(&zs, 0, sizeof(zs));
+	if (deflateInit2(&zs, block.level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+		throw IOException("Failed to initialize deflate stream");
+	}
+	if (!block.dictionary.empty()) {
+		deflateSetDictionary(&zs, reinterpret_cast<const Bytef *>(block.dictionary.data()),
+		                     static_cast<uInt>(block.dictionary.size()));
+	}
+
+	block.crc = crc32(0, reinterpret_cast<const Bytef *>(block.input.data()), static_cast<uInt>(block.input.size()));
+
+	zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(block.input.data()));
+	zs.avail_in = static_cast<uInt>(block.input.size());
+
+	// The bound does not include the marker written by the sync flush, so leave some room for that
+	const auto flush = block.is_last ? Z_FINISH : Z_SYNC_FLUSH;
+	block.output.resize(deflateBound(&zs, zs.avail_in) + 16);
+	idx_t output_size = 0;
+	while (true) {
+		zs.next_out = reinterpret_cast<Bytef *>(&block.output[output_size]);
+		zs.avail_out = static_cast<uInt>(block.output.size() - output_size);
+		const auto res = deflate(&zs, flush);
+		output_size = block.output.size() - zs.avail_out;
+		if (res == Z_STREAM_ERROR) {
+			deflateEnd(&zs);
+			throw IOException("Failed to deflate entry");
+		}
+		if (block.is_last ? res == Z_STREAM_END : zs.avail_out != 0) {
+			break;
+		}
+		block.output.resize(block.output.size() * 2);
+	}
+	deflateEnd(&zs);
+
+	block.output.resize(output_size);
+	block.input = string();
+	block.dictionary = string();
+}
+
+bool ZipBlockDeflater::CompressNext() {
+	ZipDeflateBlock *block;
+	{
+		lock_guard<mutex> guard(lock);
+		if (pending.empty()) {
+			return false;
+		}
+		block = pending.front();
+		pending.pop_front();
+	}
+
+	Compress(*block);
+
+	lock_guard<mutex> guard(lock);
+	block->is_done = true;
+	WriteBlocks();
+	return true;
+}
+
+void ZipBlockDeflater::WriteBlocks() {
+	// Write the blocks that are done, in order, until we reach one that is still being compressed
+	while (!blocks.empty() && blocks.front()->is_done) {
+		auto &block = *blocks.front();
+		const auto write_size = static_cast<int32_t>(block.output.size());
+		if (mz_zip_entry_write(zip_handle, block.output.data(), write_size) != write_size) {
+			throw IOException("Failed to write entry");
+		}
+		crc = crc32_combine(crc, block.crc, static_cast<z_off_t>(block.input_size));
+		blocks.pop_front();
+	}
+}
+
+void ZipBlockDeflater::Finish() {
+	SealBlock(true);
+	while (true) {
+		while (CompressNext()) {
+		}
+		{
+			lock_guard<mutex> guard(lock);
+			if (blocks.empty()) {
+				return;
+			}
+		}
+		// Some other thread is still compressing a block
+		std::this_thread::yield();
+	}
+}
+
 //-------------------------------------------------------------------------
 // Zip File Writer
 //-------------------------------------------------------------------------
 
-ZipFileWriter::ZipFileWriter(ClientContext &context, const string &file_name) {
+ZipFileWriter::ZipFileWriter(ClientContext &context, const string &file_name, const idx_t write_buffer_size_p) {
 	handle = mz_zip_writer_create();
 	stream = mz_stream_duckdb_create();
 	is_entry_open = false;
+	is_parallel_entry = false;
+	compression_level = Z_DEFAULT_COMPRESSION;
+	write_buffer_size = write_buffer_size_p;
+	write_buffer.reserve(write_buffer_size);
 
 	auto &fs = FileSystem::GetFileSystem(context);
 
 	auto &duckdb_stream = *static_cast<mz_stream_duckdb *>(stream);
 	duckdb_stream.fs = &fs;
 	duckdb_stream.handle = nullptr;
+	duckdb_stream.write_buffer_capacity = OUTPUT_BUFFER_SIZE;
+	duckdb_stream.write_buffer.reserve(OUTPUT_BUFFER_SIZE);
 
 	if (mz_stream_open(stream, file_name.c_str(), MZ_OPEN_MODE_CREATE | MZ_OPEN_MODE_WRITE) != MZ_OK) {
 		if (duckdb_stream.last_error.empty()) {
@@ -199,9 +467,19 @@ ZipFileWriter::ZipFileWriter(ClientContext &context, const string &file_name) {
 			throw IOException(duckdb_stream.last_error);
 		}
 	}
+
+	void *zip_handle = nullptr;
+	mz_zip_writer_get_zip_handle(handle, &zip_handle);
+	deflater = make_uniq<ZipBlockDeflater>(zip_handle);
 }
 
 ZipFileWriter::~ZipFileWriter() {
+	// If we get here without having been finalized, writing the file failed somewhere along the way. The file is
+	// incomplete either way, so drop the buffered output and the central directory instead of writing them, which
+	// could throw from within this destructor
+	if (stream) {
+		static_cast<mz_stream_duckdb *>(stream)->discard_writes = true;
+	}
 	if (handle) {
 		if (mz_zip_writer_is_open(handle)) {
 			mz_zip_writer_close(handle);
@@ -216,12 +494,22 @@ ZipFileWriter::~ZipFileWriter() {
 	}
 }
 
+void ZipFileWriter::SetCompressionLevel(const int16_t level) {
+	D_ASSERT(level >= Z_DEFAULT_COMPRESSION && level <= Z_BEST_COMPRESSION);
+	compression_level = level;
+	mz_zip_writer_set_compress_level(handle, level);
+}
+
+static uint16_t GetCompressionMethod(const int16_t level) {
+	return level == Z_NO_COMPRESSION ? MZ_COMPRESS_METHOD_STORE : MZ_COMPRESS_METHOD_DEFLATE;
+}
+
 void ZipFileWriter::AddDirectory(const string &dir_path) {
 	// Must end with a slash
 	D_ASSERT(dir_path[dir_path.size() - 1] == '/');
 	mz_zip_file file_info = {0};
 	file_info.filename = dir_path.c_str();
-	file_info.compression_method = MZ_COMPRESS_METHOD_DEFLATE;
+	file_info.compression_method = GetCompressionMethod(compression_level);
 	mz_zip_writer_add_buffer(handle, nullptr, 0, &file_info);
 }
 
@@ -231,13 +519,42 @@ void ZipFileWriter::BeginFile(const string &file_path) {
 	}
 	mz_zip_file file_info = {0};
 	file_info.filename = file_path.c_str();
-	file_info.compression_method = MZ_COMPRESS_METHOD_DEFLATE;
+	file_info.compression_method = GetCompressionMethod(compression_level);
 	if (mz_zip_writer_entry_open(handle, &file_info) != MZ_OK) {
 		throw IOException("Failed to open entry for writing");
 	}
 	is_entry_open = true;
 }
 
+void ZipFileWriter::BeginParallelFile(const string &file_path) {
+	if (is_entry_open) {
+		throw IOException("ZipWriter: Cannot open a new entry before closing the previous one");
+	}
+	if (compression_level == Z_NO_COMPRESSION) {
+		// Nothing to compress in parallel
+		BeginFile(file_path);
+		return;
+	}
+	mz_zip_file file_info = {0};
+	file_info.filename = file_path.c_str();
+	file_info.compression_method = MZ_COMPRESS_METHOD_DEFLATE;
+
+	// Open the entry in raw mode, we write the deflated data ourselves
+	void *zip_handle = nullptr;
+	mz_zip_writer_get_zip_handle(handle, &zip_handle);
+	if (mz_zip_entry_write_open(zip_handle, &file_info, compression_level, 1, nullptr) != MZ_OK) {
+		throw IOException("Failed to open entry for writing");
+	}
+	deflater->Begin(compression_level);
+	is_entry_open = true;
+	is_parallel_entry = true;
+}
+
+void ZipFileWriter::CompressBlocks() {
+	while (deflater->CompressNext()) {
+	}
+}
+
 idx_t ZipFileWriter::Write(const char *str) {
 	return Write(str, strlen(str));
 }
@@ -247,27 +564,69 @@ idx_t ZipFileWriter::Write(const string &str) {
 }
 
 idx_t ZipFileWriter::Write(const char *buffer, idx_t write_size) {
-	auto bytes_written = mz_zip_writer_entry_write(handle, buffer, write_size);
-	if (bytes_written < 0) {
-		throw IOException("Failed to write entry");
+	if (is_parallel_entry) {
+		// The deflater collects the data in blocks already
+		deflater->Write(buffer, write_size);
+		return write_size;
+	}
+	if (write_buffer.size() + write_size > write_buffer_size) {
+		FlushWriteBuffer();
+		if (write_size >= write_buffer_size) {
+			return WriteEntry(buffer, write_size);
+		}
+	}
+	write_buffer.append(buffer, write_size);
+	return write_size;
+}
+
+void ZipFileWriter::FlushWriteBuffer() {
+	if (!write_buffer.empty()) {
+		WriteEntry(write_buffer.data(), write_buffer.size());
+		write_buffer.clear();
 	}
-	return bytes_written;
+}
+
+idx_t ZipFileWriter::WriteEntry(const char *buffer, idx_t write_size) {
+	idx_t total_written = 0;
+	while (total_written < write_size) {
+		const auto chunk_size = MinValue<idx_t>(write_size - total_written, NumericLimits<int32_t>::Maximum());
+		const auto bytes_written =
+		    mz_zip_writer_entry_write(handle, buffer + total_written, static_cast<int32_t>(chunk_size));
+		if (bytes_written < 0) {
+			throw IOException("Failed to write entry");
+		}
+		total_written += static_cast<idx_t>(bytes_written);
+	}
+	return total_written;
 }
 
 void ZipFileWriter::EndFile() {
 	if (!is_entry_open) {
 		throw IOException("ZipWriter: Cannot close an entry that is not open");
 	}
-	if (mz_zip_writer_entry_close(handle) != MZ_OK) {
-		throw IOException("Failed to close entry");
+	if (is_parallel_entry) {
+		deflater->Finish();
+		void *zip_handle = nullptr;
+		mz_zip_writer_get_zip_handle(handle, &zip_handle);
+		if (mz_zip_entry_close_raw(zip_handle, static_cast<int64_t>(deflater->GetUncompressedSize()),
+		                           deflater->GetCRC()) != MZ_OK) {
+			throw IOException("Failed to close entry");
+		}
+		is_parallel_entry = false;
+	} else {
+		FlushWriteBuffer();
+		if (mz_zip_writer_entry_close(handle) != MZ_OK) {
+			throw IOException("Failed to close entry");
+		}
 	}
 	is_entry_open = false;
 }
 
-void ZipFileWriter::Finalize() {
+void ZipFileWriter::Finalize(const bool sync) {
 	if (mz_zip_writer_is_open(handle)) {
 		mz_zip_writer_close(handle);
 	}
+	static_cast<mz_stream_duckdb *>(stream)->sync_on_close = sync;
 	if (mz_stream_is_open(stream)) {
 		mz_stream_close(stream);
 	}
@@ -283,6 +642,7 @@ ZipFileReader::ZipFileReader(ClientContext &context, const string &file_name) {
 	is_entry_open = false;
 	entry_pos = 0;
 	entry_len = 0;
+	entry_compressed_len = 0;
 
 	auto &fs = FileSystem::GetFileSystem(context);
 
@@ -307,6 +667,38 @@ ZipFileReader::ZipFileReader(ClientContext &context, const string &file_name) {
 	}
 }
 
+ZipFileReader::ZipFileReader(const char *data, idx_t size) {
+	handle = mz_zip_reader_create();
+	stream = mz_stream_mem_create();
+	is_entry_open = false;
+	entry_pos = 0;
+	entry_len = 0;
+	entry_compressed_len = 0;
+
+	// The memory stream is limited to 32-bit sizes
+	if (size > static_cast<idx_t>(NumericLimits<int32_t>::Maximum())) {
+		throw IOException("Failed to open zip for reading: in-memory archives larger than 2GB are not supported");
+	}
+
+	// The buffer is only read from, and not owned by the stream
+	mz_stream_mem_set_buffer(stream, const_cast<char *>(data), static_cast<int32_t>(size));
+	if (mz_stream_open(stream, nullptr, MZ_OPEN_MODE_READ) != MZ_OK) {
+		throw IOException("Failed to open buffer for reading");
+	}
+
+	if (mz_zip_reader_open(handle, stream) != MZ_OK) {
+		throw IOException("Failed to open zip for reading (is the data a valid xlsx file?)");
+	}
+}
+
+ZipFileReader::ZipFileReader(ZipFileReader &&other) noexcept
+    : handle(other.handle), stream(other.stream), is_entry_open(other.is_entry_open), entry_pos(other.entry_pos),
+      entry_len(other.entry_len), entry_compressed_len(other.entry_compressed_len) {
+	other.handle = nullptr;
+	other.stream = nullptr;
+	other.is_entry_open = false;
+}
+
 bool ZipFileReader::TryOpenEntry(const string &file_name) {
 	if (mz_zip_reader_locate_entry(handle, file_name.c_str(), 0) != MZ_OK) {
 		return false;
@@ -326,6 +718,7 @@ bool ZipFileReader::TryOpenEntry(const string &file_name) {
 	is_entry_open = true;
 	entry_pos = 0;
 	entry_len = len;
+	entry_compressed_len = file_info->compressed_size;
 
 	return true;
 }
@@ -364,10 +757,346 @@ idx_t ZipFileReader::GetEntryLen() const {
 	return entry_len;
 }
 
+idx_t ZipFileReader::GetEntryCompressedLen() const {
+	return entry_compressed_len;
+}
+
 bool ZipFileReader::IsDone() const {
 	return entry_pos >= entry_len;
 }
 
+//-------------------------------------------------------------------------
+// Zip Stream Buffering
+//-------------------------------------------------------------------------
+// A zip archive can be read front to back by following the local file
+// headers, which is all we can do for pipes. Entries written with a
+// data descriptor don't know their compressed size up front, so for
+// those we inflate the data to find where it ends.
+//-------------------------------------------------------------------------
+
+static constexpr uint32_t ZIP_LOCAL_HEADER_SIG = 0x04034b50;
+static constexpr uint32_t ZIP_CENTRAL_HEADER_SIG = 0x02014b50;
+static constexpr uint32_t ZIP_END_OF_CENTRAL_DIR_SIG = 0x06054b50;
+static constexpr uint32_t ZIP_DATA_DESCRIPTOR_SIG = 0x08074b50;
+
+static constexpr uint16_t ZIP_FLAG_ENCRYPTED = 1 << 0;
+static constexpr uint16_t ZIP_FLAG_DATA_DESCRIPTOR = 1 << 3;
+
+static constexpr uint16_t ZIP_METHOD_STORE = 0;
+static constexpr uint16_t ZIP_METHOD_DEFLATE = 8;
+
+static uint16_t LoadLE16(const char *ptr) {
+	const auto bytes = reinterpret_cast<const uint8_t *>(ptr);
+	return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+}
+
+static uint32_t LoadLE32(const char *ptr) {
+	return LoadLE16(ptr) | (static_cast<uint32_t>(LoadLE16(ptr + 2)) << 16);
+}
+
+static uint64_t LoadLE64(const char *ptr) {
+	return LoadLE32(ptr) | (static_cast<uint64_t>(LoadLE32(ptr + 4)) << 32);
+}
+
+static void StoreLE16(string &out, const uint16_t val) {
+	out += static_cast<char>(val & 0xFF);
+	out += static_cast<char>((val >> 8) & 0xFF);
+}
+
+static void StoreLE32(string &out, const uint32_t val) {
+	StoreLE16(out, static_cast<uint16_t>(val & 0xFFFF));
+	StoreLE16(out, static_cast<uint16_t>(val >> 16));
+}
+
+class ZipStreamWalker {
+public:
+	explicit ZipStreamWalker(FileHandle &handle_p) : handle(handle_p), buffer(BUFFER_SIZE) {
+	}
+
+	// Make sure there is buffered data, returns false at the end of the stream
+	bool Fill() {
+		if (buffer_pos < buffer_end) {
+			return true;
+		}
+		buffer_pos = 0;
+		buffer_end = static_cast<idx_t>(handle.Read(buffer.data(), BUFFER_SIZE));
+		return buffer_end > 0;
+	}
+
+	// Read exactly "len" bytes, appending them to "out" unless it is null
+	void Read(idx_t len, string *out) {
+		while (len > 0) {
+			if (!Fill()) {
+				throw IOException("Failed to read zip stream: unexpected end of stream");
+			}
+			const auto count = MinValue(len, buffer_end - buffer_pos);
+			if (out) {
+				out->append(buffer.data() + buffer_pos, count);
+			}
+			buffer_pos += count;
+			len -= count;
+		}
+	}
+
+	// Inflate a deflate stream of unknown length to find its end, appending the compressed bytes to "out"
+	// unless it is null. Returns the number of inflated bytes.
+	idx_t SkipDeflate(string *out) {
+		z_stream zs;
+		memset(&zs, 0, sizeof(zs));
+		// Negative window bits for a raw deflate stream, without a zlib header
+		if (inflateInit2(&zs, -MAX_WBITS) != Z_OK) {
+			throw IOException("Failed to read zip stream: could not initialize inflate");
+		}
+		char scratch[BUFFER_SIZE];
+		auto status = Z_OK;
+		while (status != Z_STREAM_END) {
+			if (!Fill()) {
+				inflateEnd(&zs);
+				throw IOException("Failed to read zip stream: unexpected end of stream");
+			}
+			const auto avail = buffer_end - buffer_pos;
+			zs.next_in = reinterpret_cast<Bytef *>(buffer.data() + buffer_pos);
+			zs.avail_in = static_cast<uInt>(avail);
+			zs.next_out = reinterpret_cast<Bytef *>(scratch);
+			zs.avail_out = sizeof(scratch);
+			status = inflate(&zs, Z_NO_FLUSH);
+			if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+				inflateEnd(&zs);
+				throw IOException("Failed to read zip stream: invalid deflate data");
+			}
+			const auto consumed = avail - zs.avail_in;
+			if (out) {
+				out->append(buffer.data() + buffer_pos, consumed);
+			}
+			buffer_pos += consumed;
+		}
+		const auto inflated = static_cast<idx_t>(zs.total_out);
+		inflateEnd(&zs);
+		return inflated;
+	}
+
+private:
+	static constexpr idx_t BUFFER_SIZE = 16384;
+
+	FileHandle &handle;
+	vector<char> buffer;
+	idx_t buffer_pos = 0;
+	idx_t buffer_end = 0;
+};
+
+struct ZipStreamEntry {
+	string name;
+	uint16_t flags;
+	uint16_t method;
+	uint16_t time;
+	uint16_t date;
+	uint32_t crc;
+	uint64_t compressed_size;
+	uint64_t uncompressed_size;
+	uint64_t offset;
+};
+
+// The local header of an entry, with its sizes filled in
+static string RepackLocalHeader(const ZipStreamEntry &entry) {
+	string result;
+	StoreLE32(result, ZIP_LOCAL_HEADER_SIG);
+	StoreLE16(result, 20);
+	StoreLE16(result, entry.flags);
+	StoreLE16(result, entry.method);
+	StoreLE16(result, entry.time);
+	StoreLE16(result, entry.date);
+	StoreLE32(result, entry.crc);
+	StoreLE32(result, static_cast<uint32_t>(entry.compressed_size));
+	StoreLE32(result, static_cast<uint32_t>(entry.uncompressed_size));
+	StoreLE16(result, static_cast<uint16_t>(entry.name.size()));
+	StoreLE16(result, 0);
+	result += entry.name;
+	return result;
+}
+
+// The central directory of the entries, and the end of central directory record pointing to it
+static string RepackCentralDirectory(const vector<ZipStreamEntry> &entries, idx_t directory_offset) {
+	string result;
+	for (auto &entry : entries) {
+		StoreLE32(result, ZIP_CENTRAL_HEADER_SIG);
+		StoreLE16(result, 20);
+		StoreLE16(result, 20);
+		StoreLE16(result, entry.flags);
+		StoreLE16(result, entry.method);
+		StoreLE16(result, entry.time);
+		StoreLE16(result, entry.date);
+		StoreLE32(result, entry.crc);
+		StoreLE32(result, static_cast<uint32_t>(entry.compressed_size));
+		StoreLE32(result, static_cast<uint32_t>(entry.uncompressed_size));
+		StoreLE16(result, static_cast<uint16_t>(entry.name.size()));
+		// Extra field, comment, disk number, internal and external attributes
+		StoreLE16(result, 0);
+		StoreLE16(result, 0);
+		StoreLE16(result, 0);
+		StoreLE16(result, 0);
+		StoreLE32(result, 0);
+		StoreLE32(result, static_cast<uint32_t>(entry.offset));
+		result += entry.name;
+	}
+	const auto directory_size = result.size();
+
+	StoreLE32(result, ZIP_END_OF_CENTRAL_DIR_SIG);
+	StoreLE16(result, 0);
+	StoreLE16(result, 0);
+	StoreLE16(result, static_cast<uint16_t>(entries.size()));
+	StoreLE16(result, static_cast<uint16_t>(entries.size()));
+	StoreLE32(result, static_cast<uint32_t>(directory_size));
+	StoreLE32(result, static_cast<uint32_t>(directory_offset));
+	StoreLE16(result, 0);
+	return result;
+}
+
+// Hand a single entry to the filter, by wrapping it in an archive of its own
+static void InspectStreamEntry(ZipStreamFilter &filter, ZipStreamEntry entry, const string &data) {
+	entry.offset = 0;
+	auto archive = RepackLocalHeader(entry);
+	archive += data;
+	const auto directory_offset = archive.size();
+	archive += RepackCentralDirectory({entry}, directory_offset);
+
+	ZipFileReader reader(archive.data(), archive.size());
+	if (!reader.TryOpenEntry(entry.name)) {
+		throw IOException("Failed to read zip stream: entry '%s' is corrupt", entry.name);
+	}
+	filter.OnEntry(entry.name, reader);
+	reader.CloseEntry();
+}
+
+void ZipStreamBuffer::Append(const char *data, idx_t len) {
+	if (len == 0) {
+		return;
+	}
+	if (size + len > capacity) {
+		// Grow geometrically. Allocating through the buffer manager counts the buffer towards the memory limit, and
+		// fails with an out of memory error instead of growing past it
+		const auto new_capacity = MaxValue<idx_t>(NextPowerOfTwo(size + len), INITIAL_CAPACITY);
+		auto new_handle = buffer_manager.Allocate(MemoryTag::EXTENSION, new_capacity, false);
+		if (size > 0) {
+			memcpy(new_handle.Ptr(), handle.Ptr(), size);
+		}
+		handle = std::move(new_handle);
+		capacity = new_capacity;
+	}
+	memcpy(handle.Ptr() + size, data, len);
+	size += len;
+}
+
+ZipStreamBuffer ZipFileReader::BufferStream(BufferManager &buffer_manager, FileHandle &handle,
+                                            ZipStreamFilter &filter) {
+	ZipStreamWalker walker(handle);
+	vector<ZipStreamEntry> entries;
+	ZipStreamBuffer result(buffer_manager);
+
+	while (true) {
+		string header;
+		walker.Read(4, &header);
+		const auto signature = LoadLE32(header.data());
+		if (signature == ZIP_CENTRAL_HEADER_SIG || signature == ZIP_END_OF_CENTRAL_DIR_SIG) {
+			// We've seen all entries, no need to read the central directory
+			break;
+		}
+		if (signature != ZIP_LOCAL_HEADER_SIG) {
+			throw IOException("Failed to read zip stream: invalid local file header (is this an xlsx file?)");
+		}
+
+		// Read the rest of the fixed size header, and the variable length name and extra field
+		walker.Read(26, &header);
+		ZipStreamEntry entry;
+		entry.flags = LoadLE16(header.data() + 6);
+		entry.method = LoadLE16(header.data() + 8);
+		entry.time = LoadLE16(header.data() + 10);
+		entry.date = LoadLE16(header.data() + 12);
+		entry.crc = LoadLE32(header.data() + 14);
+		entry.compressed_size = LoadLE32(header.data() + 18);
+		entry.uncompressed_size = LoadLE32(header.data() + 22);
+		const auto name_len = LoadLE16(header.data() + 26);
+		const auto extra_len = LoadLE16(header.data() + 28);
+		walker.Read(name_len, &entry.name);
+		string extra;
+		walker.Read(extra_len, &extra);
+
+		if (entry.flags & ZIP_FLAG_ENCRYPTED) {
+			throw IOException("Failed to read zip stream: encrypted entries are not supported");
+		}
+
+		// Check for zip64 sizes in the extra field
+		auto is_zip64 = false;
+		for (idx_t pos = 0; pos + 4 <= extra.size();) {
+			const auto id = LoadLE16(extra.data() + pos);
+			const auto len = LoadLE16(extra.data() + pos + 2);
+			if (id == 0x0001 && len >= 16 && pos + 4 + len <= extra.size()) {
+				is_zip64 = true;
+				entry.uncompressed_size = LoadLE64(extra.data() + pos + 4);
+				entry.compressed_size = LoadLE64(extra.data() + pos + 12);
+			}
+			pos += 4 + len;
+		}
+
+		const auto keep = filter.KeepEntry(entry.name);
+		string data;
+		const auto out = keep ? &data : nullptr;
+		if (entry.flags & ZIP_FLAG_DATA_DESCRIPTOR) {
+			if (entry.method != ZIP_METHOD_DEFLATE) {
+				throw IOException("Failed to read zip stream: entry '%s' has an unknown size", entry.name);
+			}
+			walker.SkipDeflate(out);
+
+			// The descriptor may or may not start with a signature
+			string descriptor;
+			walker.Read(4, &descriptor);
+			if (LoadLE32(descriptor.data()) == ZIP_DATA_DESCRIPTOR_SIG) {
+				descriptor.clear();
+				walker.Read(4, &descriptor);
+			}
+			walker.Read(is_zip64 ? 16 : 8, &descriptor);
+			entry.crc = LoadLE32(descriptor.data());
+			entry.compressed_size = is_zip64 ? LoadLE64(descriptor.data() + 4) : LoadLE32(descriptor.data() + 4);
+			entry.uncompressed_size = is_zip64 ? LoadLE64(descriptor.data() + 12) : LoadLE32(descriptor.data() + 8);
+		} else {
+			walker.Read(entry.compressed_size, out);
+		}
+
+		if (!keep) {
+			continue;
+		}
+		if (entry.method != ZIP_METHOD_STORE && entry.method != ZIP_METHOD_DEFLATE) {
+			throw IOException("Failed to read zip stream: entry '%s' uses an unsupported compression method",
+			                  entry.name);
+		}
+		if (data.size() != entry.compressed_size || entry.uncompressed_size > NumericLimits<uint32_t>::Maximum()) {
+			throw IOException("Failed to read zip stream: entry '%s' is too large or corrupt", entry.name);
+		}
+		if (result.GetSize() + data.size() > static_cast<idx_t>(NumericLimits<int32_t>::Maximum())) {
+			throw IOException("Failed to read zip stream: archive is too large to buffer in memory");
+		}
+
+		// Repack the entry with its sizes in the local header
+		entry.flags = static_cast<uint16_t>(entry.flags & ~ZIP_FLAG_DATA_DESCRIPTOR);
+		entry.offset = result.GetSize();
+		if (filter.InspectEntry(entry.name)) {
+			InspectStreamEntry(filter, entry, data);
+		}
+		const auto local_header = RepackLocalHeader(entry);
+		result.Append(local_header.data(), local_header.size());
+		result.Append(data.data(), data.size());
+		entries.push_back(std::move(entry));
+	}
+
+	// Now write the central directory
+	const auto directory = RepackCentralDirectory(entries, result.GetSize());
+	if (entries.size() > NumericLimits<uint16_t>::Maximum() ||
+	    result.GetSize() + directory.size() > static_cast<idx_t>(NumericLimits<int32_t>::Maximum())) {
+		throw IOException("Failed to read zip stream: archive is too large to buffer in memory");
+	}
+	result.Append(directory.data(), directory.size());
+	return result;
+}
+
 ZipFileReader::~ZipFileReader() {
 	if (handle) {
 		if (mz_zip_reader_is_open(handle)) {